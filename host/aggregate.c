@@ -0,0 +1,565 @@
+/**
+ * @file aggregate.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Read many boards at once (serial ports or ptys, e.g. from loadgen) in one
+ * process using epoll, and merge their samples into one time ordered CSV
+ * stream. Each port has its own decoder (text until a zero byte, then binary
+ * frames; see ingest.c) so a corrupt or partial record only affects that
+ * port until its next line end or frame delimiter.
+ *
+ * Build (Linux): cc -O2 -I../include -o aggregate aggregate.c hostframe.c
+ * Usage: aggregate [-w window_ms] [-t seconds] [-o file] [-f csv|none]
+ *                  [-s baud] [-l listfile] [port ...]
+ *                                      (default window 200ms, run forever)
+ *
+ * CSV columns:
+ *   time_us,port,node,seq,device_ms,temperature,humidity
+ * time_us is host wall clock time. Boards synchronized to host time (see
+ * time_sync.c) send it with each sample and it is used as is. Otherwise for
+ * binary frames it is the device timestamp mapped to host time with the
+ * smallest offset seen on that port in the last 10s (the frame that arrived
+ * with least delay), which removes UART and read batching delay while
+ * following clock drift, and text samples use their arrival time. The offset
+ * is re-anchored when the device timestamp goes backwards (board reset) or
+ * the offset jumps by more than 1s (host clock stepped); timestamp roll over
+ * is followed. device_ms is the timestamp sent by the board. port is the
+ * index in the argument / list order (listed on stderr at start). node is the
+ * RS-485 node ID for node read replies (see include/node.h) and 0 otherwise.
+ *
+ * Samples are held for window_ms and emitted in time order; samples later
+ * than that are still written but counted as late. Totals, rate and CPU use
+ * are printed on stderr at exit (SIGINT / SIGTERM or -t).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include <frame.h>
+#include <node.h>
+#include "hostframe.h"
+
+#define READ_SIZE               4096        // Bytes per read
+#define MAX_RECORD              256         // Longest line / frame kept
+#define MAX_EVENTS              256
+#define OUT_SIZE                (1 << 16)
+#define OFFSET_WINDOW_US        10000000    // Offset is the minimum over this
+#define OFFSET_JUMP_US          1000000     // Larger change re-anchors
+
+typedef struct {
+    int64_t time_us;
+    uint64_t device_ms;
+    uint16_t port;
+    uint8_t node;
+    uint8_t has_ts;
+    uint32_t seq;
+    int32_t t, h;
+} sample;
+
+typedef struct {
+    int fd;
+    int binary;                         // Switched to frames
+    size_t keep;                        // Incomplete record at start of buf
+    int nv;                             // Text values collected (T, H)
+    int32_t v[2];
+    uint64_t text_ts;                   // "TS:" line (0 if none)
+    uint32_t text_seq;
+    int64_t offset_us;                  // Host time - device time (window min)
+    int64_t min_cur, min_prev;          // Minimum offset in this / last half window
+    int64_t half_end;                   // Arrival time this half window ends
+    uint64_t ms_high;                   // Device timestamp roll overs (<< 32)
+    uint32_t last_ms;                   // Last device timestamp
+    int have_offset;
+    unsigned long samples;
+    uint8_t buf[MAX_RECORD + READ_SIZE];
+} port;
+
+static volatile sig_atomic_t stop;
+static port *ports;
+static int nports;
+
+static sample *heap;                    // Min heap on time_us
+static size_t heap_len, heap_cap, heap_max;
+
+static unsigned long samples, bad, late, emitted, anchors;
+static int64_t last_out;
+static int out_fd = 1, out_none;
+static char out_buf[OUT_SIZE];
+static size_t out_len;
+
+
+static void on_signal(int sig){
+    (void)sig;
+    stop = 1;
+}
+
+static int64_t now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+// -----------------------------------------------------------------------------
+// Output (time ordered)
+// -----------------------------------------------------------------------------
+
+static void out_flush(void){
+    size_t done = 0;
+    ssize_t r;
+    while(!out_none && done < out_len){
+        r = write(out_fd, out_buf + done, out_len - done);
+        if(r <= 0){
+            perror("aggregate: write");
+            exit(1);
+        }
+        done += r;
+    }
+    out_len = 0;
+}
+
+static char *put_int(char *p, int64_t v){
+    char tmp[20];
+    uint64_t m = v < 0 ? -(uint64_t)v : (uint64_t)v;
+    int n = 0;
+    if(v < 0)
+        *p++ = '-';
+    do{
+        tmp[n++] = '0' + m % 10;
+        m /= 10;
+    }while(m != 0);
+    while(n > 0)
+        *p++ = tmp[--n];
+    return p;
+}
+
+static char *put_fixed(char *p, int32_t v){
+    uint32_t m = v < 0 ? -(uint32_t)v : (uint32_t)v;
+    if(v < 0)
+        *p++ = '-';
+    p = put_int(p, m / 100);
+    *p++ = '.';
+    *p++ = '0' + m % 100 / 10;
+    *p++ = '0' + m % 10;
+    return p;
+}
+
+static void emit(const sample *s){
+    char *p;
+    emitted++;
+    if(s->time_us < last_out)
+        late++;                         // Arrived after its window
+    else
+        last_out = s->time_us;
+    if(out_len + 128 > sizeof(out_buf))
+        out_flush();
+    p = out_buf + out_len;
+    p = put_int(p, s->time_us);
+    *p++ = ',';
+    p = put_int(p, s->port);
+    *p++ = ',';
+    p = put_int(p, s->node);
+    *p++ = ',';
+    p = put_int(p, s->seq);
+    *p++ = ',';
+    if(s->has_ts)
+        p = put_int(p, s->device_ms);
+    *p++ = ',';
+    p = put_fixed(p, s->t);
+    *p++ = ',';
+    p = put_fixed(p, s->h);
+    *p++ = '\n';
+    out_len = p - out_buf;
+}
+
+static void heap_push(const sample *s){
+    size_t i, parent;
+    sample tmp;
+    if(heap_len == heap_cap){
+        heap_cap = heap_cap ? heap_cap * 2 : 1024;
+        heap = realloc(heap, heap_cap * sizeof(sample));
+        if(heap == NULL)
+            exit(1);
+    }
+    i = heap_len++;
+    heap[i] = *s;
+    while(i > 0){
+        parent = (i - 1) / 2;
+        if(heap[parent].time_us <= heap[i].time_us)
+            break;
+        tmp = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = tmp;
+        i = parent;
+    }
+    if(heap_len > heap_max)
+        heap_max = heap_len;
+}
+
+static void heap_pop(void){
+    size_t i = 0, c;
+    sample tmp;
+    heap[0] = heap[--heap_len];
+    for(;;){
+        c = 2 * i + 1;
+        if(c >= heap_len)
+            break;
+        if(c + 1 < heap_len && heap[c + 1].time_us < heap[c].time_us)
+            c++;
+        if(heap[i].time_us <= heap[c].time_us)
+            break;
+        tmp = heap[c];
+        heap[c] = heap[i];
+        heap[i] = tmp;
+        i = c;
+    }
+}
+
+// Emit samples older than before
+static void drain(int64_t before){
+    while(heap_len > 0 && heap[0].time_us <= before){
+        emit(&heap[0]);
+        heap_pop();
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// Decoding (per port)
+// -----------------------------------------------------------------------------
+
+static void text_line(port *pt, const char *p, size_t len, int64_t arrival){
+    const char *end = p + len;
+    sample s;
+    int i;
+
+    if(len == 0){
+        if(pt->nv == 2){
+            // Blank line ends a sample
+            memset(&s, 0, sizeof(s));
+            s.time_us = arrival;
+            if(pt->text_ts != 0){
+                s.device_ms = pt->text_ts;
+                s.has_ts = 1;
+                s.time_us = (int64_t)pt->text_ts * 1000;
+            }
+            s.port = pt - ports;
+            s.seq = pt->text_seq++;
+            s.t = pt->v[0];
+            s.h = pt->v[1];
+            heap_push(&s);
+            pt->samples++;
+            samples++;
+        }
+        pt->nv = 0;
+        pt->text_ts = 0;
+        return;
+    }
+    if(len > 4 && memcmp(p, "TS: ", 4) == 0 && pt->nv == 2){
+        // Host time (after the values)
+        for(p += 4; p < end && *p >= '0' && *p <= '9'; ++p)
+            pt->text_ts = pt->text_ts * 10 + (*p - '0');
+        return;
+    }
+    if(len > 3 && p[0] == 'T' && p[1] == ':')
+        i = 0;
+    else if(len > 3 && p[0] == 'H' && p[1] == ':')
+        i = 1;
+    else
+        return;                         // Derived values and other output
+    if(i != pt->nv || !hostframe_parse_fixed(p + 3, end, &pt->v[i])){
+        bad++;
+        pt->nv = 0;
+        return;
+    }
+    pt->nv = i + 1;
+}
+
+/**
+ * Map a device timestamp (ms since boot) to host time. The offset is the
+ * minimum over a sliding window of two half windows so it follows drift.
+ */
+static int64_t device_time(port *pt, uint32_t ms, int64_t arrival){
+    int wrapped = pt->have_offset && ms < pt->last_ms && pt->last_ms - ms >= 0x80000000u;
+    int64_t offset;
+
+    if(wrapped)
+        pt->ms_high += (uint64_t)1 << 32;
+    offset = arrival - (int64_t)(pt->ms_high + ms) * 1000;
+    if(!pt->have_offset || (ms < pt->last_ms && !wrapped) ||
+            offset > pt->offset_us + OFFSET_JUMP_US || offset < pt->offset_us - OFFSET_JUMP_US){
+        // First frame, board reset or clock step: start over from this frame
+        if(pt->have_offset)
+            anchors++;
+        pt->ms_high = 0;
+        offset = arrival - (int64_t)ms * 1000;
+        pt->min_cur = offset;
+        pt->min_prev = INT64_MAX;
+        pt->half_end = arrival + OFFSET_WINDOW_US / 2;
+        pt->have_offset = 1;
+    }else if(arrival >= pt->half_end){
+        pt->min_prev = arrival >= pt->half_end + OFFSET_WINDOW_US / 2 ? INT64_MAX : pt->min_cur;
+        pt->min_cur = offset;
+        pt->half_end = arrival + OFFSET_WINDOW_US / 2;
+    }else if(offset < pt->min_cur){
+        pt->min_cur = offset;
+    }
+    pt->last_ms = ms;
+    pt->offset_us = pt->min_cur < pt->min_prev ? pt->min_cur : pt->min_prev;
+    return (int64_t)(pt->ms_high + ms) * 1000 + pt->offset_us;
+}
+
+static void frame(port *pt, uint8_t *buf, size_t len, int64_t arrival){
+    long n = hostframe_decode(buf, len);
+    size_t header;
+    sample s;
+
+    if(n < 2){
+        bad++;
+        return;
+    }
+    memset(&s, 0, sizeof(s));
+    s.port = pt - ports;
+    header = (buf[0] & FRAME_EPOCH) ? FRAME_EPOCH_SIZE : FRAME_HEADER_SIZE;
+    if((buf[0] & NODE_REPLY) && buf[1] == NODE_FN_READ && n >= 3 + 4 && buf[2] >= 2){
+        // RS-485 node read reply: first registers are temperature, humidity
+        s.node = buf[0] & ~NODE_REPLY;
+        s.time_us = arrival;
+        s.t = (int16_t)hostframe_get16(&buf[3]);
+        s.h = hostframe_get16(&buf[5]);
+    }else if((buf[0] & ~FRAME_EPOCH) == FRAME_SAMPLE && n >= (long)header + 4 &&
+            n <= (long)header + FRAME_MAX_PAYLOAD){
+        s.seq = buf[1];
+        s.device_ms = hostframe_get32(&buf[2]);
+        s.has_ts = 1;
+        s.t = (int16_t)hostframe_get16(&buf[header]);
+        s.h = hostframe_get16(&buf[header + 2]);
+        if(header == FRAME_EPOCH_SIZE){
+            // Board has host time
+            s.device_ms |= (uint64_t)hostframe_get32(&buf[6]) << 32;
+            s.time_us = (int64_t)s.device_ms * 1000;
+        }else{
+            s.time_us = device_time(pt, s.device_ms, arrival);
+        }
+    }else{
+        return;                         // Other frame types
+    }
+    heap_push(&s);
+    pt->samples++;
+    samples++;
+}
+
+/**
+ * Decode records in pt->buf (keep + len bytes). Incomplete record is moved
+ * to the front.
+ */
+static void decode(port *pt, size_t len, int64_t arrival){
+    uint8_t *p = pt->buf, *end = pt->buf + pt->keep + len, *e, *z;
+
+    while(p < end){
+        if(!pt->binary){
+            e = memchr(p, '\n', end - p);
+            z = memchr(p, 0, (e != NULL ? e : end) - p);
+            if(z != NULL){
+                pt->binary = 1;
+                p = z + 1;
+                continue;
+            }
+            if(e == NULL)
+                break;
+            text_line(pt, (const char*)p, (e > p && e[-1] == '\r') ? e - p - 1 : e - p, arrival);
+            p = e + 1;
+        }else{
+            e = memchr(p, 0, end - p);
+            if(e == NULL)
+                break;
+            if(e > p)
+                frame(pt, p, e - p, arrival);
+            p = e + 1;
+        }
+    }
+    if(end - p > MAX_RECORD){
+        bad++;                          // Not a record. Resync at next end.
+        p = end;
+    }
+    pt->keep = end - p;
+    memmove(pt->buf, p, pt->keep);
+}
+
+static int open_port(const char *path, long baud){
+    struct termios t;
+    speed_t speed = baud == 115200 ? B115200 : baud == 57600 ? B57600 :
+            baud == 38400 ? B38400 : baud == 19200 ? B19200 : B9600;
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if(fd >= 0 && isatty(fd) && tcgetattr(fd, &t) == 0){
+        cfmakeraw(&t);
+        cfsetispeed(&t, speed);
+        cfsetospeed(&t, speed);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    return fd;
+}
+
+
+int main(int argc, char **argv){
+    const char *list = NULL, *out_path = NULL;
+    double window_ms = 200, seconds = 0;
+    long baud = 9600;
+    char **paths = NULL, line[4096];
+    int npaths = 0, opt, ep, n, i;
+    struct epoll_event ev, events[MAX_EVENTS];
+    struct rlimit rl;
+    struct rusage ru;
+    int64_t start, end = 0, arrival, window;
+    double wall, cpu;
+    FILE *lf;
+    ssize_t r;
+    port *pt;
+
+    while((opt = getopt(argc, argv, "w:t:o:f:s:l:")) != -1){
+        switch(opt){
+        case 'w': window_ms = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        case 'o': out_path = optarg; break;
+        case 'f': out_none = strcmp(optarg, "none") == 0; break;
+        case 's': baud = atol(optarg); break;
+        case 'l': list = optarg; break;
+        default:
+            fprintf(stderr, "Usage: aggregate [-w window_ms] [-t seconds] [-o file] "
+                    "[-f csv|none] [-s baud] [-l listfile] [port ...]\n");
+            return 1;
+        }
+    }
+
+    // Ports from list file then arguments
+    paths = malloc(sizeof(char*) * (argc + 1));
+    for(i = optind; i < argc; ++i)
+        paths[npaths++] = argv[i];
+    if(list != NULL){
+        if((lf = fopen(list, "r")) == NULL){
+            perror(list);
+            return 1;
+        }
+        while(fgets(line, sizeof(line), lf) != NULL){
+            line[strcspn(line, "\r\n")] = '\0';
+            if(line[0] == '\0')
+                continue;
+            paths = realloc(paths, sizeof(char*) * (npaths + 1));
+            paths[npaths++] = strdup(line);
+        }
+        fclose(lf);
+    }
+    if(npaths == 0){
+        fprintf(stderr, "aggregate: no ports\n");
+        return 1;
+    }
+
+    // One fd per port (raise open file limit if needed)
+    if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)npaths + 16){
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    if(out_path != NULL && (out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+        perror(out_path);
+        return 1;
+    }
+    ep = epoll_create1(0);
+    ports = calloc(npaths, sizeof(port));
+    if(ep < 0 || ports == NULL)
+        return 1;
+    for(i = 0; i < npaths; ++i){
+        ports[i].fd = open_port(paths[i], baud);
+        if(ports[i].fd < 0){
+            perror(paths[i]);
+            return 1;
+        }
+        ev.events = EPOLLIN;
+        ev.data.ptr = &ports[i];
+        if(epoll_ctl(ep, EPOLL_CTL_ADD, ports[i].fd, &ev) != 0){
+            perror("aggregate: epoll_ctl");
+            return 1;
+        }
+        fprintf(stderr, "port %d: %s\n", i, paths[i]);
+    }
+    nports = npaths;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    window = (int64_t)(window_ms * 1000);
+    start = now_us();
+    if(seconds > 0)
+        end = start + (int64_t)(seconds * 1e6);
+    if(!out_none){
+        static const char header[] = "time_us,port,node,seq,device_ms,temperature,humidity\n";
+        memcpy(out_buf, header, sizeof(header) - 1);
+        out_len = sizeof(header) - 1;
+    }
+
+    while(!stop && (end == 0 || now_us() < end)){
+        n = epoll_wait(ep, events, MAX_EVENTS, 50);
+        if(n < 0 && errno != EINTR)
+            break;
+        for(i = 0; i < n; ++i){
+            pt = events[i].data.ptr;
+            // Read what is there now (level triggered: rest on next wait)
+            r = read(pt->fd, pt->buf + pt->keep, READ_SIZE);
+            if(r > 0){
+                decode(pt, r, now_us());
+            }else if(r == 0 || (errno != EAGAIN && errno != EINTR)){
+                epoll_ctl(ep, EPOLL_CTL_DEL, pt->fd, NULL);
+            }
+        }
+        arrival = now_us();
+        drain(arrival - window);
+        if(out_len > sizeof(out_buf) / 2)
+            out_flush();
+    }
+    drain(INT64_MAX);
+    out_flush();
+
+    wall = (now_us() - start) / 1e6;
+    getrusage(RUSAGE_SELF, &ru);
+    cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+            ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    fprintf(stderr, "aggregate: %d ports, %lu samples in %.1fs (%.0f/s), %lu bad, "
+            "%lu late, %lu re-anchored, max %zu held; CPU %.2fs (%.1f%%)\n", nports,
+            samples, wall, samples / wall, bad, late, anchors, heap_max, cpu,
+            100 * cpu / wall);
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file command_test.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Test the command parser by injecting bytes through the simulated UCA0RXBUF
+ * and the real uca0uart receive path (uca0uart_handle_read), the same way the
+ * RX ISR does. Bytes arrive in chunks with command_next called between them
+ * like the main loop would. Random input is fed too; build with
+ * -fsanitize=address,undefined to catch overruns of the parser buffers.
+ *
+ * Build (Linux): cc -O2 -I../include -Isim -o command_test command_test.c ../src/command.c ../src/uca0uart.c ../src/spsc_buffer.c ../src/rings.c ../src/fmt.c ../src/msp430helper.c
+ * Usage: command_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <command.h>
+#include <uca0uart.h>
+#include <msp430.h>
+
+// Simulated registers (see sim/msp430.h)
+volatile uint8_t P1OUT;
+volatile uint8_t IE2, IFG2;
+volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0MCTL;
+volatile uint8_t UCA0TXBUF, UCA0RXBUF, UCA0STAT;
+
+typedef struct {
+    uint8_t id;
+    int32_t arg;
+} expect;
+
+static unsigned long errors;
+static command got[64];
+static unsigned int got_len;
+
+// Parser internals (src/command.c)
+extern uint8_t command_buf[COMMAND_LINE_MAX];
+bool command_number(unsigned int start, unsigned int end, int32_t *dest);
+
+
+// Receive one byte as the RX ISR would
+static void rx(uint8_t b){
+    UCA0RXBUF = b;
+    uca0uart_handle_read();
+}
+
+// Main loop: handle all complete commands
+static void poll(void){
+    command cmd;
+    while(command_next(&cmd)){
+        if(got_len < sizeof(got) / sizeof(got[0]))
+            got[got_len++] = cmd;
+    }
+}
+
+// Inject data in chunks of up to chunk bytes, polling between chunks
+static void inject(const uint8_t *data, unsigned int len, unsigned int chunk){
+    unsigned int i;
+    for(i = 0; i < len; ++i){
+        rx(data[i]);
+        if((i + 1) % chunk == 0)
+            poll();
+    }
+    poll();
+}
+
+static void check(const char *name, const char *input, unsigned int len,
+        const expect *exp, unsigned int count){
+    unsigned int chunk, i;
+    for(chunk = 1; chunk <= 8; ++chunk){
+        got_len = 0;
+        command_init();
+        inject((const uint8_t*)input, len, chunk);
+        if(got_len != count){
+            printf("FAIL %s (chunk %u): %u commands, expected %u\n", name, chunk, got_len, count);
+            errors++;
+            continue;
+        }
+        for(i = 0; i < count; ++i){
+            if(got[i].id != exp[i].id || got[i].arg != exp[i].arg){
+                printf("FAIL %s (chunk %u): command %u is 0x%02X %ld, expected 0x%02X %ld\n",
+                        name, chunk, i, got[i].id, (long)got[i].arg, exp[i].id, (long)exp[i].arg);
+                errors++;
+            }
+        }
+    }
+    printf("%-8s %s\n", errors ? "" : "ok", name);
+}
+
+#define CHECK(name, input, ...) do{ \
+        const expect e[] = { __VA_ARGS__ }; \
+        check(name, input, sizeof(input) - 1, e, sizeof(e) / sizeof(e[0])); \
+    }while(0)
+
+// Parse a number directly (longer than line command arguments can be)
+static void check_number(const char *str, bool ok, int32_t value){
+    unsigned int len = strlen(str);
+    int32_t got_value = 0;
+    bool got_ok;
+
+    memcpy(command_buf, str, len);
+    got_ok = command_number(0, len, &got_value);
+    if(got_ok != ok || (ok && got_value != value)){
+        printf("FAIL number \"%s\": %s %ld\n", str, got_ok ? "ok" : "invalid", (long)got_value);
+        errors++;
+    }
+}
+
+
+int main(void){
+    const uint8_t calib[] = { 'K', 1, 0, '$', '\r', '\n', 0xFF, 'D', 0x80, 'D', 'k' };
+    unsigned int i, n, lines, state = 0;
+    uint8_t b;
+    command cmd;
+
+    uca0uart_init(uca0uart_BUAD_9600);
+
+    CHECK("single", "DkR", {'D', 0}, {'k', 0}, {'R', 0});
+    CHECK("rate", "$RATE 2000\r\n", {COMMAND_RATE, 2000});
+    CHECK("case", "$rate -5\n", {COMMAND_RATE, -5});
+    CHECK("lines", "$READ\r$DUMP\n$STATS\r\n",
+            {COMMAND_READ, 0}, {COMMAND_DUMP, 0}, {COMMAND_STATS, 0});
+    CHECK("format", "$FMT bin\n$fmt TEXT\n$FMT X\n",
+            {COMMAND_FORMAT, 1}, {COMMAND_FORMAT, 0}, {COMMAND_INVALID, 0});
+    CHECK("spaces", "$RATE   100\n", {COMMAND_RATE, 100});
+    CHECK("band", "$TBAND 25\n$hband 0\n", {COMMAND_TBAND, 25}, {COMMAND_HBAND, 0});
+    CHECK("bad", "$RATE\n$RATE x\n$DUMP 1\n$NOPE\n$\n",
+            {COMMAND_INVALID, 0}, {COMMAND_INVALID, 0}, {COMMAND_INVALID, 0},
+            {COMMAND_INVALID, 0}, {COMMAND_INVALID, 0});
+    CHECK("long", "$RATE 12345678901234567\nD",
+            {COMMAND_INVALID, 0}, {'D', 0});
+    CHECK("mixed", "P$READ\nW", {'P', 0}, {COMMAND_READ, 0}, {'W', 0});
+    CHECK("high", "\x80\x81\x85\xFF" "D\xC3", {'D', 0});
+
+    // Argument bytes may be anything (including '$' and line endings)
+    for(n = 1; n <= 8; ++n){
+        got_len = 0;
+        command_init();
+        inject(calib, sizeof(calib), n);
+        if(got_len != 3 || got[0].id != 'K' || memcmp(got[0].args, &calib[1], 8) != 0 ||
+                got[1].id != 'D' || got[2].id != 'k'){
+            printf("FAIL args (chunk %u)\n", n);
+            errors++;
+        }
+    }
+    printf("%-8s args\n", errors ? "" : "ok");
+
+    // Numbers out of int32 range are invalid (not wrapped)
+    check_number("2147483647", true, INT32_MAX);
+    check_number("-2147483647", true, -INT32_MAX);
+    check_number("2147483648", false, 0);
+    check_number("2147483650", false, 0);
+    check_number("99999999999", false, 0);
+    check_number("-99999999999", false, 0);
+    printf("%-8s number\n", errors ? "" : "ok");
+
+    // Random input: lines of any length always end (at least one command
+    // per line; single byte commands are counted too)
+    srand(1);
+    command_init();
+    n = 0;
+    lines = 0;
+    for(i = 0; i < 1000000; ++i){
+        b = rand() & 0x7F;
+        if(b > 'z')
+            b = (b & 1) ? '\n' : '$';  // Lots of lines
+        if(b == '$' && state == 0)
+            state = 1;
+        else if(b == '\n' && state == 1){
+            state = 0;
+            lines++;
+        }
+        rx(b);
+        while(command_next(&cmd))
+            n++;
+    }
+    if(lines == 0 || n < lines){
+        printf("FAIL random: %u commands for %u lines\n", n, lines);
+        errors++;
+    }else{
+        printf("ok       random (1M bytes, %u lines)\n", lines);
+    }
+
+    printf("%s\n", errors ? "FAILED" : "PASSED");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file derived_test.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Compare the integer derived metrics (src/derived.c) with the float
+ * formulas they approximate, over a sweep of temperature (-40.00 to 150.00 C,
+ * the AHT10 formula's range; above 85 C reported separately) and relative
+ * humidity (1.00 to 100.00 %) in the sensor's 0.01 units:
+ *   dew point          Magnus (b = 17.62, c = 243.12 C)
+ *   absolute humidity  216.74 * RH/100 * 6.112 * e^(bT/(c+T)) / (T + 273.15)
+ *   heat index         Rothfusz regression (Celsius coefficients), T 26.7
+ *                      to 50 C (below: the temperature; above: clamped)
+ * Prints the largest and mean absolute error of each and where the largest
+ * was found, and fails if any largest error is above its bound.
+ * The MSP430's int is 16 bits but the host's is 32, so sums derived.c leaves
+ * in int are also checked to fit in 16 bits over the whole range.
+ *
+ * Build (Linux): cc -O2 -I../include -o derived_test derived_test.c ../src/derived.c -lm
+ * Usage: derived_test [step]       (step in 0.01 units; default 1)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <derived.h>
+
+#define MAGNUS_B            17.62
+#define MAGNUS_C            243.12
+#define AH_MAX              655.35          // Largest absolute humidity result
+
+typedef struct {
+    const char *name;
+    double bound;                               // largest error allowed
+    double max, sum, max_t, max_rh;
+    unsigned long n;
+} error;
+
+
+static double dew_point(double t, double rh){
+    double g = log(rh / 100) + MAGNUS_B * t / (MAGNUS_C + t);
+    return MAGNUS_C * g / (MAGNUS_B - g);
+}
+
+static double abs_humidity(double t, double rh){
+    double es = 6.112 * exp(MAGNUS_B * t / (MAGNUS_C + t));
+    return 216.74 * rh / 100 * es / (t + 273.15);
+}
+
+static double heat_index(double t, double r){
+    return -8.78469475556 + 1.61139411 * t + 2.33854883889 * r
+            - 0.14611605 * t * r - 0.012308094 * t * t
+            - 0.0164248277778 * r * r + 0.002211732 * t * t * r
+            + 0.00072546 * t * r * r - 0.000003582 * t * t * r * r;
+}
+
+/**
+ * Sums derived.c computes in int (16 bits on the MSP430). Anything that does
+ * not fit must be cast to int32_t in derived.c instead (as MAGNUS_C + t is:
+ * it passes 32767 above 84.55 C).
+ * @return 1 if one does not fit in int16_t
+ */
+static int int16_sums(int t, int rh){
+    int hi_t = t < 2670 ? 2670 : t > 5000 ? 5000 : t;
+    return (int16_t)(hi_t + 5) != hi_t + 5 ||          // heat index t
+            (int16_t)(rh + 5) != rh + 5;                // heat index r (unsigned)
+}
+
+static void add(error *e, double got, double want, double t, double rh){
+    double d = fabs(got - want);
+    if(d > e->max){
+        e->max = d;
+        e->max_t = t;
+        e->max_rh = rh;
+    }
+    e->sum += d;
+    e->n++;
+}
+
+static int print(const error *e, const char *unit){
+    printf("%-30s max %.3f %s at %.2f C %.2f %%RH, mean %.4f (%lu points)\n", e->name,
+            e->max, unit, e->max_t, e->max_rh, e->sum / e->n, e->n);
+    return e->max > e->bound;
+}
+
+int main(int argc, char **argv){
+    int step = argc > 1 ? atoi(argv[1]) : 1;
+    error dp = { .name = "dew point", .bound = 0.05 };
+    error ah = { .name = "absolute humidity", .bound = 0.25 };
+    error hi = { .name = "heat index (26.7 to 50 C)", .bound = 0.75 };
+    error hi40 = { .name = "heat index (26.7 to 40 C)", .bound = 0.5 };
+    error dp_hot = { .name = "dew point (above 85 C)", .bound = 0.05 };
+    error ah_hot = { .name = "absolute humidity (above 85 C)", .bound = 0.5 };
+    int t, rh, failed = 0;
+    double tf, rf, h, a;
+
+    if(step < 1)
+        step = 1;
+    for(t = -4000; t <= 15000; t += step){
+        for(rh = 100; rh <= 10000; rh += step){
+            tf = t / 100.0;
+            rf = rh / 100.0;
+            if(!failed && int16_sums(t, rh)){
+                printf("int sum overflows 16 bits at %.2f C %.2f %%RH\n", tf, rf);
+                failed = 1;
+            }
+            a = abs_humidity(tf, rf);
+            if(a > AH_MAX)
+                a = AH_MAX;                     // Saturates (unsigned 16-bit)
+            add(t <= 8500 ? &dp : &dp_hot, derived_dew_point(t, rh) / 100.0,
+                    dew_point(tf, rf), tf, rf);
+            add(t <= 8500 ? &ah : &ah_hot, derived_abs_humidity(t, rh) / 100.0, a, tf, rf);
+            if(t >= 2670 && t <= 5000){
+                h = derived_heat_index(t, rh) / 100.0;
+                add(&hi, h, heat_index(tf, rf), tf, rf);
+                if(t <= 4000)
+                    add(&hi40, h, heat_index(tf, rf), tf, rf);
+            }
+        }
+    }
+    failed |= print(&dp, "C");
+    failed |= print(&ah, "g/m^3");
+    failed |= print(&hi, "C");
+    failed |= print(&hi40, "C");
+    failed |= print(&dp_hot, "C");
+    failed |= print(&ah_hot, "g/m^3");
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file filter_bench.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Benchmark filter_add (src/filter.c) for each filter type: host CPU cycles
+ * per sample (x86 time stamp counter; nanoseconds elsewhere) and the mean
+ * absolute error of the reported values against a noise free signal. Host
+ * cycles only show the relative cost of the filter types on the MSP430.
+ *
+ * Build (Linux): cc -O2 -I../include -o filter_bench filter_bench.c ../src/filter.c
+ * Usage: filter_bench [samples]        (default 1000000, best of 5 runs)
+ *
+ * The input is a slow ramp (0.01 every 100 samples, both channels) with
+ * uniform +/-0.10 noise, in aht10 units.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <filter.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define UNIT                "cycles"
+static uint64_t ticks(void){
+    return __rdtsc();
+}
+#else
+#define UNIT                "ns"
+static uint64_t ticks(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+#define NOISE               10          // +/- 0.10
+#define START               2000        // 20.00
+
+
+static const struct {
+    unsigned int type;
+    const char *name;
+} types[] = {
+    { FILTER_NONE, "none" },
+    { FILTER_MA, "moving average" },
+    { FILTER_EMA, "EMA" },
+    { FILTER_MEDIAN3, "median 3" },
+    { FILTER_MEDIAN5, "median 5" },
+};
+
+static int16_t *clean, *noisy;
+
+
+static double bench(unsigned int type, unsigned int samples, volatile unsigned int *sink){
+    unsigned int i, n = 0;
+    uint64_t t;
+
+    filter_set_type(type);
+    t = ticks();
+    for(i = 0; i < samples; ++i)
+        n += filter_add(noisy[i], noisy[i]);
+    t = ticks() - t;
+    *sink = n;
+    return (double)t / samples;
+}
+
+static double error(unsigned int type, unsigned int samples){
+    unsigned int i, n = 0;
+    double sum = 0;
+
+    filter_set_type(type);
+    for(i = 0; i < samples; ++i){
+        if(filter_add(noisy[i], noisy[i])){
+            sum += abs(filter_temperature - clean[i]);
+            n++;
+        }
+    }
+    return sum / n;
+}
+
+int main(int argc, char **argv){
+    unsigned int samples = 1000000, i, j, run;
+    volatile unsigned int sink;
+    double best, t;
+
+    if(argc > 1)
+        samples = strtoul(argv[1], NULL, 0);
+    clean = malloc(samples * sizeof(*clean));
+    noisy = malloc(samples * sizeof(*noisy));
+    if(clean == NULL || noisy == NULL){
+        fprintf(stderr, "filter_bench: out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for(i = 0; i < samples; ++i){
+        clean[i] = START + (i / 100) % 2000;
+        noisy[i] = clean[i] + rand() % (2 * NOISE + 1) - NOISE;
+    }
+
+    printf("%-16s %10s %12s\n", "filter", UNIT "/sample", "mean error");
+    for(j = 0; j < sizeof(types) / sizeof(types[0]); ++j){
+        best = 1e18;
+        for(run = 0; run < 5; ++run){
+            t = bench(types[j].type, samples, &sink);
+            if(t < best)
+                best = t;
+        }
+        printf("%-16s %10.1f %12.2f\n", types[j].name, best,
+                error(types[j].type, samples));
+    }
+    free(clean);
+    free(noisy);
+    return 0;
+}
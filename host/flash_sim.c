@@ -0,0 +1,280 @@
+/**
+ * @file flash_sim.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Run the flash sample log (src/flashlog.c) against a simulated flash
+ * controller that takes the place of src/flash.c. The simulation enforces
+ * erase before write (writing a word that is not erased is an error), keeps
+ * erase and write counts per segment and can cut power part way through a
+ * record write. Samples are added for many simulated days with random resets;
+ * after each reset the log is dumped (through the 'F' dump path) and checked
+ * against the samples that were committed: the dump must be the newest of
+ * them in order, with nothing missing in between.
+ *
+ * Build (Linux): cc -O2 -I../include -Isim -include sim/msp430.h -DFLASHLOG_START='((uintptr_t)sim_main_flash)' -o flash_sim flash_sim.c ../src/flashlog.c
+ * Usage: flash_sim [days] [resets] [seed]      (default 60 days, 200 resets)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <flash.h>
+#include <flashlog.h>
+#include <history.h>
+#include <uca0uart.h>
+
+#define SEG_WORDS           (FLASH_MAIN_SEGMENT_SIZE / 2)
+#define SAMPLE_MS           500             // Default sample interval
+
+uint16_t sim_main_flash[FLASHLOG_SEGMENTS * SEG_WORDS];
+
+static unsigned long seg_erases[FLASHLOG_SEGMENTS];
+static unsigned long seg_writes[FLASHLOG_SEGMENTS];
+static unsigned long violations;
+static long cut_words = -1;                 // Words until power is cut
+static jmp_buf power_cut;
+
+// Dump capture (see uca0uart stubs)
+static uint8_t dump[1 << 16];
+static size_t dump_len;
+
+// Samples whose record was committed, oldest first
+static uint32_t *committed;
+static size_t committed_len, committed_cap;
+static uint32_t batch[FLASHLOG_BATCH];
+static unsigned int batch_len;
+
+// Run state (kept across longjmp)
+static unsigned long n, samples, next_reset, resets, done_resets, cuts, checks;
+
+
+// -----------------------------------------------------------------------------
+// Simulated flash controller (flash.h)
+// -----------------------------------------------------------------------------
+
+static size_t word_index(const void *addr){
+    size_t i = (const uint16_t*)addr - sim_main_flash;
+    if((const uint16_t*)addr < sim_main_flash || i >= FLASHLOG_SEGMENTS * SEG_WORDS){
+        printf("access outside log area\n");
+        exit(1);
+    }
+    return i;
+}
+
+void flash_init(void){
+}
+
+void flash_erase(const void *addr){
+    size_t seg = word_index(addr) / SEG_WORDS;
+    memset(&sim_main_flash[seg * SEG_WORDS], 0xFF, FLASH_MAIN_SEGMENT_SIZE);
+    seg_erases[seg]++;
+}
+
+void flash_write(const void *dest, const uint16_t *src, unsigned int count){
+    size_t i = word_index(dest), n;
+    for(n = 0; n < count; ++n, ++i){
+        if(cut_words == 0){
+            cut_words = -1;
+            longjmp(power_cut, 1);
+        }
+        if(cut_words > 0)
+            cut_words--;
+        if(i >= FLASHLOG_SEGMENTS * SEG_WORDS || i / SEG_WORDS != word_index(dest) / SEG_WORDS){
+            printf("write crosses segment\n");
+            exit(1);
+        }
+        if(sim_main_flash[i] != FLASH_ERASED_WORD && violations++ < 5)
+            printf("write of 0x%04X to unerased word %zu (0x%04X)\n", src[n], i,
+                    sim_main_flash[i]);
+        sim_main_flash[i] &= src[n];        // Programming only clears bits
+        seg_writes[i / SEG_WORDS]++;
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// uca0uart stubs (dump capture)
+// -----------------------------------------------------------------------------
+
+unsigned int uca0uart_write_avail(void){
+    return 64;
+}
+
+unsigned int uca0uart_write_bytes(uint8_t *data, unsigned int len){
+    memcpy(&dump[dump_len], data, len);
+    dump_len += len;
+    return len;
+}
+
+void uca0uart_end_message(void){
+}
+
+
+// -----------------------------------------------------------------------------
+// Test
+// -----------------------------------------------------------------------------
+
+static void commit(uint32_t ts){
+    if(committed_len == committed_cap){
+        committed_cap = committed_cap ? committed_cap * 2 : 4096;
+        committed = realloc(committed, committed_cap * sizeof(uint32_t));
+    }
+    committed[committed_len++] = ts;
+}
+
+// Records that were cut short (no commit word); they still take their space
+static size_t uncommitted(void){
+    const uint16_t *seg;
+    size_t i, pos, words, count = 0;
+    for(i = 0; i < FLASHLOG_SEGMENTS; ++i){
+        seg = &sim_main_flash[i * SEG_WORDS];
+        for(pos = 1; pos < SEG_WORDS && (seg[pos] & 0xFF00) == FLASHLOG_MAGIC; pos += words){
+            words = 2 + 4 * (seg[pos] & 0xFF);
+            if(pos + words <= SEG_WORDS && seg[pos + words - 1] != 0x0000)
+                count++;
+        }
+    }
+    return count;
+}
+
+// Dump the log and compare with the newest committed samples
+static int check(void){
+    uint32_t ts;
+    size_t count, i, first, keep;
+
+    dump_len = 0;
+    flashlog_dump_start();
+    while(flashlog_dump_next());
+    count = dump[1] | (dump[2] << 8);
+    if(dump[0] != 'F' || dump_len != 3 + count * HISTORY_RECORD_BYTES || count > committed_len){
+        printf("bad dump: %zu samples, %zu bytes, %zu committed\n", count, dump_len,
+                committed_len);
+        return 0;
+    }
+    first = committed_len - count;
+    for(i = 0; i < count; ++i){
+        memcpy(&ts, &dump[3 + i * HISTORY_RECORD_BYTES], 4);
+        if(ts != committed[first + i]){
+            printf("sample %zu of dump is %u, expected %u\n", i, ts, committed[first + i]);
+            return 0;
+        }
+    }
+    // All but the segment being filled must be kept (less records cut short)
+    keep = (FLASHLOG_SEGMENTS - 1) * ((SEG_WORDS - 1) / (2 + 4 * FLASHLOG_BATCH));
+    keep = (keep - uncommitted()) * FLASHLOG_BATCH;
+    if(committed_len >= keep + FLASHLOG_SEGMENTS * 64 && count < keep){
+        printf("only %zu samples kept\n", count);
+        return 0;
+    }
+    return 1;
+}
+
+static void report(double days){
+    unsigned long i, min_e = ~0UL, max_e = 0, writes = 0;
+    for(i = 0; i < FLASHLOG_SEGMENTS; ++i){
+        if(seg_erases[i] < min_e)
+            min_e = seg_erases[i];
+        if(seg_erases[i] > max_e)
+            max_e = seg_erases[i];
+        writes += seg_writes[i];
+    }
+    printf("%.0f days, %lu logged samples, %lu resets, %lu power cuts, %lu checks\n",
+            days, (unsigned long)committed_len, done_resets, cuts, checks);
+    printf("erases per segment: %lu to %lu (one every %.1f hours); words written: %lu\n",
+            min_e, max_e, days * 24 / ((min_e + max_e) / 2.0), writes);
+    printf("10000 erase cycles last %.1f years\n", 10000 * days / ((min_e + max_e) / 2.0) / 365);
+    printf("erase before write violations: %lu\n", violations);
+}
+
+int main(int argc, char **argv){
+    double days = argc > 1 ? atof(argv[1]) : 60;
+    unsigned int s;
+    int pass = 1;
+
+    resets = argc > 2 ? strtoul(argv[2], NULL, 10) : 200;
+    samples = days * 86400e3 / SAMPLE_MS;
+
+    srand(argc > 3 ? atoi(argv[3]) : 1);
+    // Log area is erased when the board is programmed
+    memset(sim_main_flash, 0xFF, sizeof(sim_main_flash));
+
+    flash_init();
+    next_reset = samples / (resets + 1);
+    if(setjmp(power_cut) != 0){
+        // Power cut mid record: batch and record are lost
+        cuts++;
+        batch_len = 0;
+        n++;
+    }
+    for(;;){
+        // flashlog_init restarts decimation: next sample is logged
+        while(n % FLASHLOG_DECIMATE != 0)
+            n++;
+        flashlog_init();
+        if(!check()){
+            pass = 0;
+            break;
+        }
+        checks++;
+        while(n < samples && n < next_reset){
+            // Every FLASHLOG_DECIMATE'th sample is logged, committed once
+            // FLASHLOG_BATCH are written. Cut power somewhere in the record.
+            if(n % FLASHLOG_DECIMATE == 0){
+                batch[batch_len++] = n;
+                if(batch_len == 1 && rand() % 50 == 0)
+                    cut_words = rand() % (2 + 4 * FLASHLOG_BATCH);
+            }
+            flashlog_add(n, n & 0x3FFF, n % 10000, 0);
+            n++;
+            if(batch_len == FLASHLOG_BATCH){
+                for(s = 0; s < batch_len; ++s)
+                    commit(batch[s]);
+                batch_len = 0;
+                cut_words = -1;
+            }
+        }
+        if(n >= samples)
+            break;
+        // Reset: open record is lost, decimation restarts
+        batch_len = 0;
+        done_resets++;
+        next_reset = n + samples / (resets + 1) + rand() % 1000;
+    }
+    if(pass && !check())
+        pass = 0;
+
+    report(days);
+    if(violations != 0)
+        pass = 0;
+    printf("%s\n", pass ? "PASSED" : "FAILED");
+    return pass ? 0 : 1;
+}
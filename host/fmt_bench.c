@@ -0,0 +1,168 @@
+/**
+ * @file fmt_bench.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Benchmark fixed point formatting straight into a ring buffer (fmt_fixed)
+ * against the previous path (int_to_str, shift digits to insert the decimal
+ * point, then copy the string into the ring). Also checks both give the same
+ * text. Host timings only show the relative cost.
+ *
+ * Build (Linux): cc -O2 -I../include -o fmt_bench fmt_bench.c ../src/fmt.c ../src/msp430helper.c ../src/spsc_buffer.c
+ * Usage: fmt_bench [rounds]            (default 20, best of 5 runs)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fmt.h>
+#include <msp430helper.h>
+#include <spsc_buffer.h>
+
+#define SIZE                64          // Must match WB_SIZE in src/uca0uart.c
+#define MIN_VALUE           -32768      // Range of int16_t values
+#define MAX_VALUE           32767
+
+
+static volatile uint8_t array[SIZE];
+static volatile spsc_buffer sb;
+
+
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Previous path (format_number from src/main.c, then uca0uart_write_str)
+static char *format_number(int32_t value, char *buf){
+    unsigned int len, i;
+    len = int_to_str(value, buf);
+    while(len < 4){
+        for(i = len + 1; i > 1; --i)
+            buf[i] = buf[i - 1];
+        buf[1] = '0';
+        len++;
+    }
+    buf[len + 1] = buf[len];
+    buf[len] = buf[len - 1];
+    buf[len - 1] = buf[len - 2];
+    buf[len - 2] = '.';
+    return buf[0] == '-' ? buf : &buf[1];
+}
+
+static unsigned int old_write(int32_t value){
+    char buf[14], *str = format_number(value, buf);
+    spsc_span spans[2];
+    unsigned int i, j, pos = 0;
+    spsc_peek_write(&sb, spans);
+    for(i = 0; i < 2; ++i){
+        for(j = 0; j < spans[i].len && str[pos] != '\0'; ++j)
+            spans[i].data[j] = str[pos++];
+    }
+    spsc_commit_write(&sb, pos);
+    return pos;
+}
+
+static unsigned int new_write(int32_t value){
+    spsc_span spans[2];
+    unsigned int len;
+    spsc_peek_write(&sb, spans);
+    len = fmt_fixed(value, 2, 0, spans);
+    spsc_commit_write(&sb, len);
+    return len;
+}
+
+static unsigned int drain(char *out){
+    unsigned int n = 0;
+    uint8_t b;
+    while(spsc_read(&sb, &b))
+        out[n++] = b;
+    out[n] = '\0';
+    return n;
+}
+
+static double bench(unsigned int (*write)(int32_t), unsigned int rounds){
+    char out[SIZE + 1];
+    unsigned int r;
+    int32_t v;
+    double t = now();
+    for(r = 0; r < rounds; ++r){
+        for(v = MIN_VALUE; v <= MAX_VALUE; ++v){
+            if(write(v) == 0){
+                drain(out);
+                write(v);
+            }
+        }
+    }
+    drain(out);
+    return (now() - t) * 1e9 / ((double)rounds * (MAX_VALUE - MIN_VALUE + 1));
+}
+
+int main(int argc, char **argv){
+    char a[SIZE + 1], b[SIZE + 1];
+    unsigned int rounds = 20, bad = 0;
+    int32_t v;
+    double t_old, t_new;
+
+    if(argc > 1)
+        rounds = strtoul(argv[1], NULL, 0);
+
+    // Same output for every value (ring position varies so wrap is covered)
+    spsc_init(&sb, array, SIZE);
+    for(v = MIN_VALUE; v <= MAX_VALUE; ++v){
+        old_write(v);
+        drain(a);
+        new_write(v);
+        drain(b);
+        if(strcmp(a, b) != 0 && bad++ < 5)
+            fprintf(stderr, "fmt_bench: %ld: \"%s\" != \"%s\"\n", (long)v, a, b);
+    }
+    if(bad){
+        printf("FAIL: %u mismatches\n", bad);
+        return 1;
+    }
+
+    // Best of several runs (host timing is noisy)
+    t_old = t_new = 1e9;
+    for(v = 0; v < 5; ++v){
+        double t = bench(old_write, rounds);
+        if(t < t_old)
+            t_old = t;
+        t = bench(new_write, rounds);
+        if(t < t_new)
+            t_new = t;
+    }
+    printf("int_to_str + copy   %6.1f ns/value\n", t_old);
+    printf("fmt_fixed direct    %6.1f ns/value\n", t_new);
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file frame_decode.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Decode binary telemetry frames (see include/frame.h) into CSV.
+ *
+ * Build (Linux): cc -O2 -I../include -o frame_decode frame_decode.c hostframe.c
+ * Usage: frame_decode [file_or_tty]    (reads stdin if none given)
+ *
+ * A serial port must already be configured (e.g. stty -F /dev/ttyUSB0 9600
+ * raw). One line is printed per good frame:
+ *   S,seq,timestamp_ms,temperature,humidity[,dew_point,abs_humidity,heat_index]
+ *   W,seq,timestamp_ms,tmin,tmax,tmean,tsd,hmin,hmax,hmean,hsd
+ *   A,seq,timestamp_ms,state,changed,temperature,humidity
+ *   Q,seq,timestamp_ms,age_ms,temperature,humidity
+ *   Y,seq,timestamp_ms,receipt_ms,error_ms,drift_ppm
+ * timestamp_ms is time since boot, or host time (ms since 1970) once the
+ * board has been synchronized (see time_sync.c).
+ * Frames with bad CRC or length and gaps in sequence numbers are counted and
+ * reported on stderr at exit.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <frame.h>
+#include "hostframe.h"
+
+#define MAX_ENCODED             256
+
+
+static unsigned long frames_ok, frames_bad, frames_lost;
+
+
+static void handle_frame(uint8_t *buf, size_t len){
+    static int have_seq = 0;
+    static uint8_t last_seq;
+    const uint8_t *p;
+    int n, i, plen, header;
+    unsigned long long ts;
+
+    n = (int)hostframe_decode(buf, len);
+    header = (n > 0 && (buf[0] & FRAME_EPOCH)) ? FRAME_EPOCH_SIZE : FRAME_HEADER_SIZE;
+    if(n < header || n > header + FRAME_MAX_PAYLOAD){
+        frames_bad++;
+        return;
+    }
+    frames_ok++;
+
+    if(have_seq)
+        frames_lost += (uint8_t)(buf[1] - last_seq - 1);
+    have_seq = 1;
+    last_seq = buf[1];
+
+    ts = hostframe_get32(&buf[2]);
+    if(header == FRAME_EPOCH_SIZE)
+        ts |= (unsigned long long)hostframe_get32(&buf[6]) << 32;
+    p = &buf[header];
+    plen = n - header;
+
+    switch(buf[0] & ~FRAME_EPOCH){
+    case FRAME_SAMPLE:
+        if(plen != 4 && plen != 10)
+            break;
+        printf("S,%u,%llu,%.2f,%.2f", buf[1], ts,
+                (int16_t)hostframe_get16(p) / 100.0, hostframe_get16(p + 2) / 100.0);
+        for(i = 4; i < plen; i += 2)
+            printf(",%.2f", (int16_t)hostframe_get16(p + i) / 100.0);
+        printf("\n");
+        return;
+    case FRAME_SUMMARY:
+        if(plen != 16)
+            break;
+        printf("W,%u,%llu", buf[1], ts);
+        for(i = 0; i < plen; i += 2){
+            if(i % 8 == 6)
+                printf(",%.2f", hostframe_get16(p + i) / 100.0);     // sd is unsigned
+            else
+                printf(",%.2f", (int16_t)hostframe_get16(p + i) / 100.0);
+        }
+        printf("\n");
+        return;
+    case FRAME_ALARM:
+        if(plen != 6)
+            break;
+        printf("A,%u,%llu,0x%02X,0x%02X,%.2f,%.2f\n", buf[1], ts,
+                p[0], p[1], (int16_t)hostframe_get16(p + 2) / 100.0, hostframe_get16(p + 4) / 100.0);
+        return;
+    case FRAME_QUERY:
+        if(plen != 6)
+            break;
+        printf("Q,%u,%llu,%u,%.2f,%.2f\n", buf[1], ts,
+                hostframe_get16(p), (int16_t)hostframe_get16(p + 2) / 100.0, hostframe_get16(p + 4) / 100.0);
+        return;
+    case FRAME_SYNC:
+        if(plen != 12)
+            break;
+        printf("Y,%u,%llu,%lu,%ld,%ld\n", buf[1], ts,
+                (unsigned long)hostframe_get32(p),
+                (long)(int32_t)hostframe_get32(p + 4),
+                (long)(int32_t)hostframe_get32(p + 8));
+        return;
+    }
+    fprintf(stderr, "frame_decode: unknown frame type %u (%d bytes)\n", buf[0], plen);
+}
+
+int main(int argc, char **argv){
+    FILE *f = stdin;
+    uint8_t enc[MAX_ENCODED];
+    size_t len = 0;
+    int c, overflow = 0;
+
+    if(argc > 1){
+        f = fopen(argv[1], "rb");
+        if(f == NULL){
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while((c = fgetc(f)) != EOF){
+        if(c == 0){
+            // Delimiter. Empty or oversized frames are noise (e.g. text output).
+            if(overflow)
+                frames_bad++;
+            else if(len > 0)
+                handle_frame(enc, len);
+            len = 0;
+            overflow = 0;
+        }else if(len < sizeof(enc)){
+            enc[len++] = c;
+        }else{
+            overflow = 1;
+        }
+    }
+
+    fprintf(stderr, "frame_decode: %lu frames, %lu bad, %lu lost\n",
+            frames_ok, frames_bad, frames_lost);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file history_decode.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Decode a sample history dump (see include/history.h) into CSV.
+ *
+ * Build (Linux): cc -O2 -o history_decode history_decode.c
+ * Usage: history_decode [dump_file]    (reads stdin if no file given)
+ *
+ * Output columns: seq,timestamp_ms,temperature,humidity,status
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Must match include/history.h
+#define KEYFRAME_BYTES      8
+
+
+static int next_byte(FILE *f){
+    int c = fgetc(f);
+    if(c == EOF){
+        fprintf(stderr, "history_decode: truncated dump\n");
+        exit(1);
+    }
+    return c;
+}
+
+static uint32_t get_varint(const uint8_t *buf, unsigned int len, unsigned int *pos){
+    uint32_t v = 0;
+    unsigned int shift = 0;
+    while(*pos < len){
+        uint8_t b = buf[(*pos)++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if(!(b & 0x80))
+            return v;
+        shift += 7;
+    }
+    fprintf(stderr, "history_decode: truncated varint\n");
+    exit(1);
+}
+
+static int32_t unzigzag(uint32_t v){
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void print_sample(uint32_t seq, uint32_t ts, int16_t temp, uint16_t hum){
+    printf("%lu,%lu,%.2f,%.2f,%u\n", (unsigned long)seq, (unsigned long)ts,
+            temp / 100.0, (hum & 0x3FFF) / 100.0, hum >> 14);
+}
+
+int main(int argc, char **argv){
+    FILE *f = stdin;
+    uint8_t buf[256];
+    int c;
+    unsigned int count, nblocks, ratio, decoded = 0, total_bytes = 0;
+    uint32_t seq;
+
+    if(argc > 1 && (f = fopen(argv[1], "rb")) == NULL){
+        perror(argv[1]);
+        return 1;
+    }
+
+    // Skip anything (ASCII output) before the dump header
+    while((c = fgetc(f)) != EOF && c != 'H');
+    if(c == EOF){
+        fprintf(stderr, "history_decode: no dump found\n");
+        return 1;
+    }
+
+    count = next_byte(f);
+    seq = next_byte(f);
+    seq |= (uint32_t)next_byte(f) << 8;
+    seq |= (uint32_t)next_byte(f) << 16;
+    seq |= (uint32_t)next_byte(f) << 24;
+    ratio = next_byte(f);
+    ratio |= next_byte(f) << 8;
+    nblocks = next_byte(f);
+
+    printf("seq,timestamp_ms,temperature,humidity,status\n");
+    while(nblocks--){
+        unsigned int len = next_byte(f), pos, i;
+        uint32_t ts, dt = 0;
+        int16_t temp;
+        uint16_t hum;
+
+        for(i = 0; i < len; ++i)
+            buf[i] = next_byte(f);
+        total_bytes += len;
+        if(len == 0)
+            continue;
+        if(len < KEYFRAME_BYTES){
+            fprintf(stderr, "history_decode: short block\n");
+            return 1;
+        }
+
+        // Keyframe
+        ts = buf[0] | (uint32_t)buf[1] << 8 | (uint32_t)buf[2] << 16 | (uint32_t)buf[3] << 24;
+        temp = (int16_t)(buf[4] | buf[5] << 8);
+        hum = buf[6] | buf[7] << 8;
+        print_sample(seq++, ts, temp, hum);
+        decoded++;
+
+        // Encoded samples
+        pos = KEYFRAME_BYTES;
+        while(pos < len){
+            uint32_t v = get_varint(buf, len, &pos);
+            switch(v & 3){
+            case 2:
+                // Tiny form
+                v >>= 2;
+                temp += (int)(v % 9) / 3 - 1;
+                hum += (int)(v % 3) - 1;
+                dt += unzigzag(v / 9);
+                break;
+            case 1:
+                // Short form
+                dt += unzigzag(v >> 2);
+                if(pos >= len){
+                    fprintf(stderr, "history_decode: truncated sample\n");
+                    return 1;
+                }
+                temp += (buf[pos] >> 4) - 8;
+                hum += (buf[pos] & 0x0F) - 8;
+                pos++;
+                break;
+            case 0:
+                // Long form
+                dt += unzigzag(v >> 2);
+                temp += unzigzag(get_varint(buf, len, &pos));
+                hum += unzigzag(get_varint(buf, len, &pos));
+                break;
+            default:
+                fprintf(stderr, "history_decode: bad sample form\n");
+                return 1;
+            }
+            ts += dt;
+            print_sample(seq++, ts, temp, hum);
+            decoded++;
+        }
+    }
+
+    if(decoded != count)
+        fprintf(stderr, "history_decode: expected %u samples, decoded %u\n", count, decoded);
+    fprintf(stderr, "%u samples in %u bytes; compression ratio %u.%02u (device reported %u.%02u)\n",
+            decoded, total_bytes,
+            total_bytes ? decoded * KEYFRAME_BYTES * 100 / total_bytes / 100 : 0,
+            total_bytes ? decoded * KEYFRAME_BYTES * 100 / total_bytes % 100 : 0,
+            ratio / 100, ratio % 100);
+    return decoded == count ? 0 : 1;
+}
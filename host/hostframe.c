@@ -0,0 +1,162 @@
+/**
+ * @file hostframe.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hostframe.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+static uint16_t crc_table[256];             // Remainder for each byte
+static int crc_ready;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+static void crc_init(void){
+    unsigned int i, j;
+    uint16_t c;
+    for(i = 0; i < 256; ++i){
+        c = i << 8;
+        for(j = 0; j < 8; ++j)
+            c = (c & 0x8000) ? (c << 1) ^ 0x1021 : c << 1;
+        crc_table[i] = c;
+    }
+    crc_ready = 1;
+}
+
+uint16_t hostframe_crc16(const uint8_t *data, size_t len){
+    uint16_t crc = 0xFFFF;
+    if(!crc_ready)
+        crc_init();
+    while(len--)
+        crc = (crc << 8) ^ crc_table[(crc >> 8) ^ *data++];
+    return crc;
+}
+
+size_t hostframe_cobs_encode(const uint8_t *src, size_t len, uint8_t *dest){
+    size_t i, code_pos = 0, out = 1;
+    uint8_t code = 1;
+    for(i = 0; i < len; ++i){
+        if(src[i] != 0){
+            dest[out++] = src[i];
+            if(++code != 0xFF)
+                continue;
+        }
+        // Zero byte (or full block of 254 non-zero bytes)
+        dest[code_pos] = code;
+        code_pos = out++;
+        code = 1;
+    }
+    dest[code_pos] = code;
+    dest[out++] = 0;
+    return out;
+}
+
+long hostframe_cobs_decode(const uint8_t *src, size_t len, uint8_t *dest){
+    size_t i = 0, out = 0;
+    unsigned int code, j;
+    while(i < len){
+        code = src[i++];
+        if(code == 0 || i + code - 1 > len)
+            return -1;
+        for(j = 1; j < code; ++j)
+            dest[out++] = src[i++];     // out < i so never overtakes input
+        if(code != 0xFF && i < len)
+            dest[out++] = 0;
+    }
+    return (long)out;
+}
+
+size_t hostframe_encode(uint8_t *raw, size_t len, uint8_t *dest){
+    hostframe_put16(&raw[len], hostframe_crc16(raw, len));
+    return hostframe_cobs_encode(raw, len + FRAME_CRC_SIZE, dest);
+}
+
+long hostframe_decode(uint8_t *buf, size_t len){
+    long n = hostframe_cobs_decode(buf, len, buf);
+    if(n < FRAME_CRC_SIZE)
+        return -1;
+    n -= FRAME_CRC_SIZE;
+    if(hostframe_crc16(buf, n) != hostframe_get16(&buf[n]))
+        return -1;
+    return n;
+}
+
+uint16_t hostframe_get16(const uint8_t *p){
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t hostframe_get32(const uint8_t *p){
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint8_t *hostframe_put16(uint8_t *p, uint16_t value){
+    p[0] = value;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+uint8_t *hostframe_put32(uint8_t *p, uint32_t value){
+    return hostframe_put16(hostframe_put16(p, value), value >> 16);
+}
+
+int hostframe_parse_fixed(const char *p, const char *end, int32_t *dest){
+    int32_t v = 0;
+    int neg = 0, digits = 0, dec = -1;
+    if(p < end && *p == '-'){
+        neg = 1;
+        p++;
+    }
+    for(; p < end; ++p){
+        if(*p >= '0' && *p <= '9'){
+            if(dec < 2){
+                v = v * 10 + (*p - '0');
+                if(dec >= 0)
+                    dec++;
+            }
+            digits++;
+        }else if(*p == '.' && dec < 0){
+            dec = 0;
+        }else{
+            return 0;
+        }
+    }
+    if(digits == 0 || digits > 9)
+        return 0;
+    if(dec < 0)
+        dec = 0;
+    while(dec++ < 2)
+        v *= 10;
+    *dest = neg ? -v : v;
+    return 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file hostframe.h
+ * @brief Helpers shared by the host tools: CRC-16, COBS encode / decode of
+ * frames (see include/frame.h) and parsing of fixed point text (hundredths).
+ * Same CRC and framing as src/frame.c, table driven for host throughput.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <frame.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * CRC-16/CCITT-FALSE (same as frame_crc16 starting from 0xFFFF)
+ * @param data Bytes to check
+ * @param len Number of bytes
+ * @return CRC
+ */
+uint16_t hostframe_crc16(const uint8_t *data, size_t len);
+
+/**
+ * COBS encode and add the trailing 0x00 delimiter
+ * @param src Bytes to encode
+ * @param len Number of bytes
+ * @param dest Encoded bytes (at least len + len / 254 + 2 bytes)
+ * @return Number of encoded bytes (including delimiter)
+ */
+size_t hostframe_cobs_encode(const uint8_t *src, size_t len, uint8_t *dest);
+
+/**
+ * COBS decode one frame (without its delimiter)
+ * @param src Encoded bytes
+ * @param len Number of encoded bytes
+ * @param dest Decoded bytes (len bytes; may be src to decode in place)
+ * @return Number of decoded bytes, or -1 if malformed
+ */
+long hostframe_cobs_decode(const uint8_t *src, size_t len, uint8_t *dest);
+
+/**
+ * Append CRC to an unencoded frame and COBS encode it
+ * @param raw Frame without CRC. Must have room for FRAME_CRC_SIZE more bytes.
+ * @param len Length of frame in raw
+ * @param dest Encoded frame (including delimiter)
+ * @return Number of encoded bytes
+ */
+size_t hostframe_encode(uint8_t *raw, size_t len, uint8_t *dest);
+
+/**
+ * COBS decode one frame (without its delimiter) in place and check its CRC
+ * @param buf Encoded frame. Replaced by the decoded frame.
+ * @param len Number of encoded bytes
+ * @return Length of the decoded frame without CRC, or -1 if malformed or the
+ *         CRC does not match
+ */
+long hostframe_decode(uint8_t *buf, size_t len);
+
+/**
+ * Little endian 16 / 32-bit values
+ */
+uint16_t hostframe_get16(const uint8_t *p);
+uint32_t hostframe_get32(const uint8_t *p);
+uint8_t *hostframe_put16(uint8_t *p, uint16_t value);
+uint8_t *hostframe_put32(uint8_t *p, uint32_t value);
+
+/**
+ * Parse a fixed point number ("23.45", "-1.5", "7") as hundredths. Digits
+ * after the second decimal are ignored.
+ * @param p First character
+ * @param end One past the last character
+ * @param dest Value in hundredths
+ * @return 1 if valid else 0
+ */
+int hostframe_parse_fixed(const char *p, const char *end, int32_t *dest);
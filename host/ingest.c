@@ -0,0 +1,589 @@
+/**
+ * @file ingest.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Ingest the device output stream (text "T:"/"H:" samples or binary frames,
+ * see include/frame.h) from a serial port, pty or capture file and write
+ * samples as CSV or a binary columnar file. Input is read in large blocks and
+ * decoded in place: lines and frames are parsed where they sit in the read
+ * buffer, with no allocation per sample. The stream is text until the first
+ * zero byte (the 'B' command sends one) and binary frames after it.
+ *
+ * Build (Linux): cc -O2 -I../include -o ingest ingest.c hostframe.c
+ * Usage: ingest [-f csv|col|none] [-o file] [-s baud] [input]
+ *        ingest -g text|bin [-n samples] > capture   Write a synthetic capture
+ *        ingest -B [-f csv|col|none] capture         Benchmark decoding
+ *
+ * Input is stdin if none given; a tty is set to raw at the given baud (default
+ * 9600). CSV columns:
+ *   seq,device_ms,temperature,humidity,dew_point,abs_humidity,heat_index
+ * seq is the frame sequence number (text: sample count) and device_ms the
+ * frame timestamp (text: the "TS:" line or empty). Once the board has host
+ * time (see time_sync.c) the timestamp is host time in ms since 1970 instead
+ * of time since boot. Derived values are empty if not sent.
+ *
+ * Columnar file: blocks of up to COL_ROWS samples, all little endian:
+ *   "THC2", uint32 rows, then one array per column of rows entries each:
+ *   uint32 seq, uint64 device_ms, int16 temperature, int16 humidity,
+ *   int16 dew_point, int16 abs_humidity, int16 heat_index
+ * Values are hundredths; missing ones are COL_NONE.
+ *
+ * Benchmark mode loads the capture into memory, decodes it 5 times and prints
+ * the best rate in samples/s, with output formatted but not written.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <frame.h>
+#include "hostframe.h"
+
+#define READ_SIZE               (1 << 16)   // Bytes per read
+#define MAX_RECORD              256         // Longest line / frame kept
+#define OUT_SIZE                (1 << 16)   // Output buffer
+#define COL_ROWS                4096        // Rows per columnar block
+#define COL_NONE                INT16_MIN   // Missing value in columnar file
+
+#define CSV_HEADER              "seq,device_ms,temperature,humidity,dew_point,abs_humidity,heat_index\n"
+
+#define OUT_CSV                 0
+#define OUT_COL                 1
+#define OUT_NONE                2
+
+typedef struct {
+    uint32_t seq;
+    uint64_t ts;
+    int32_t v[5];                       // temp, hum, dp, ah, hi (hundredths)
+    int nv;                             // Values present (2 or 5)
+    int has_ts;
+} sample;
+
+
+static int binary;                      // Stream switched to frames
+static sample cur;                      // Text sample being collected
+static uint32_t text_seq;
+static unsigned long samples, bad, skipped, lost;
+static int have_seq;
+static uint8_t last_seq;
+
+static int out_fmt = OUT_CSV;
+static int out_fd = 1;
+static int out_discard;                 // Benchmark: format only
+static char out_buf[OUT_SIZE];
+static size_t out_len;
+
+static uint32_t col_seq[COL_ROWS];
+static uint64_t col_ts[COL_ROWS];
+static int16_t col_v[5][COL_ROWS];
+static unsigned int col_rows;
+
+
+// -----------------------------------------------------------------------------
+// Output
+// -----------------------------------------------------------------------------
+
+static void out_flush(void){
+    size_t done = 0;
+    ssize_t r;
+    if(!out_discard){
+        while(done < out_len){
+            r = write(out_fd, out_buf + done, out_len - done);
+            if(r <= 0){
+                perror("ingest: write");
+                exit(1);
+            }
+            done += r;
+        }
+    }
+    out_len = 0;
+}
+
+static void out_bytes(const void *data, size_t len){
+    if(out_len + len > sizeof(out_buf))
+        out_flush();
+    memcpy(out_buf + out_len, data, len);
+    out_len += len;
+}
+
+static char *put_uint(char *p, uint32_t v){
+    char tmp[10];
+    int n = 0;
+    do{
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    }while(v != 0);
+    while(n > 0)
+        *p++ = tmp[--n];
+    return p;
+}
+
+static char *put_uint64(char *p, uint64_t v){
+    char tmp[20];
+    int n = 0;
+    if(v <= UINT32_MAX)
+        return put_uint(p, v);          // Time since boot (faster)
+    do{
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    }while(v != 0);
+    while(n > 0)
+        *p++ = tmp[--n];
+    return p;
+}
+
+// Hundredths as fixed point (e.g. -123 is "-1.23")
+static char *put_fixed(char *p, int32_t v){
+    uint32_t m;
+    if(v < 0){
+        *p++ = '-';
+        m = -(uint32_t)v;
+    }else{
+        m = v;
+    }
+    p = put_uint(p, m / 100);
+    *p++ = '.';
+    *p++ = '0' + m % 100 / 10;
+    *p++ = '0' + m % 10;
+    return p;
+}
+
+static void col_flush(void){
+    uint32_t rows = col_rows;
+    int i;
+    if(rows == 0)
+        return;
+    out_bytes("THC2", 4);
+    out_bytes(&rows, 4);
+    out_bytes(col_seq, rows * 4);
+    out_bytes(col_ts, rows * 8);
+    for(i = 0; i < 5; ++i)
+        out_bytes(col_v[i], rows * 2);
+    col_rows = 0;
+}
+
+static void emit(const sample *s){
+    char *p;
+    int i;
+
+    samples++;
+    if(out_fmt == OUT_CSV){
+        if(out_len + 128 > sizeof(out_buf))
+            out_flush();
+        p = out_buf + out_len;
+        p = put_uint(p, s->seq);
+        *p++ = ',';
+        if(s->has_ts)
+            p = put_uint64(p, s->ts);
+        for(i = 0; i < 5; ++i){
+            *p++ = ',';
+            if(i < s->nv)
+                p = put_fixed(p, s->v[i]);
+        }
+        *p++ = '\n';
+        out_len = p - out_buf;
+    }else if(out_fmt == OUT_COL){
+        col_seq[col_rows] = s->seq;
+        col_ts[col_rows] = s->ts;
+        for(i = 0; i < 5; ++i)
+            col_v[i][col_rows] = i < s->nv ? (int16_t)s->v[i] : COL_NONE;
+        if(++col_rows == COL_ROWS)
+            col_flush();
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// Decoding
+// -----------------------------------------------------------------------------
+
+// One text line (without line ending)
+static void text_line(const char *p, size_t len){
+    static const char names[5][4] = { "T: ", "H: ", "DP:", "AH:", "HI:" };
+    const char *end = p + len;
+    int i;
+
+    if(len == 0){
+        // Blank line ends a sample
+        if(cur.nv >= 2){
+            cur.seq = text_seq++;
+            emit(&cur);
+        }
+        cur.nv = 0;
+        cur.has_ts = 0;
+        return;
+    }
+    if(len > 4 && memcmp(p, "TS: ", 4) == 0 && cur.nv >= 2){
+        // Host time (after the values)
+        for(cur.ts = 0, p += 4; p < end && *p >= '0' && *p <= '9'; ++p)
+            cur.ts = cur.ts * 10 + (*p - '0');
+        cur.has_ts = 1;
+        return;
+    }
+    for(i = 0; i < 5; ++i){
+        if(len > 3 && memcmp(p, names[i], 3) == 0)
+            break;
+    }
+    // Values must come in order (T, H, then derived)
+    if(i == 5 || i != cur.nv){
+        skipped++;                      // Other output (e.g. statistics)
+        if(i != 5)
+            cur.nv = 0;
+        return;
+    }
+    p += 3;
+    while(p < end && *p == ' ')
+        p++;
+    if(!hostframe_parse_fixed(p, end, &cur.v[i])){
+        bad++;
+        cur.nv = 0;
+        return;
+    }
+    cur.nv = i + 1;
+}
+
+// One COBS frame (without delimiter). Decoded in place.
+static void frame(uint8_t *buf, size_t len){
+    long n = hostframe_decode(buf, len);
+    unsigned int j, plen, header;
+    sample s;
+
+    header = (n > 0 && (buf[0] & FRAME_EPOCH)) ? FRAME_EPOCH_SIZE : FRAME_HEADER_SIZE;
+    if(n < (long)header || n > (long)header + FRAME_MAX_PAYLOAD){
+        bad++;
+        return;
+    }
+    if(have_seq)
+        lost += (uint8_t)(buf[1] - last_seq - 1);
+    have_seq = 1;
+    last_seq = buf[1];
+
+    plen = n - header;
+    if((buf[0] & ~FRAME_EPOCH) != FRAME_SAMPLE || (plen != 4 && plen != 10)){
+        skipped++;                      // Other frame types
+        return;
+    }
+    s.seq = buf[1];
+    s.ts = hostframe_get32(&buf[2]);
+    if(header == FRAME_EPOCH_SIZE)
+        s.ts |= (uint64_t)hostframe_get32(&buf[6]) << 32;
+    s.has_ts = 1;
+    s.nv = plen / 2;
+    for(j = 0; j < (unsigned int)s.nv; ++j)
+        s.v[j] = (int16_t)hostframe_get16(&buf[header + 2 * j]);
+    s.v[1] = (uint16_t)s.v[1];          // Humidity is unsigned
+    emit(&s);
+}
+
+/**
+ * Decode a block of input. Records are parsed where they are in buf.
+ * @return Bytes at the end of buf that are an incomplete record
+ */
+static size_t decode(uint8_t *buf, size_t len){
+    uint8_t *p = buf, *end = buf + len, *e, *z;
+
+    while(p < end){
+        if(!binary){
+            e = memchr(p, '\n', end - p);
+            z = memchr(p, 0, (e != NULL ? e : end) - p);
+            if(z != NULL){
+                binary = 1;             // 'B' command: frames from here on
+                p = z + 1;
+                continue;
+            }
+            if(e == NULL)
+                break;
+            text_line((const char*)p, (e > p && e[-1] == '\r') ? e - p - 1 : e - p);
+            p = e + 1;
+        }else{
+            e = memchr(p, 0, end - p);
+            if(e == NULL)
+                break;
+            if(e > p)
+                frame(p, e - p);
+            p = e + 1;
+        }
+    }
+    if(end - p > MAX_RECORD){
+        bad++;                          // Too long to be a record. Drop.
+        return 0;
+    }
+    return end - p;
+}
+
+/**
+ * Decode a whole stream, given in blocks of up to READ_SIZE bytes
+ * The incomplete record at the end of a block is moved to the front of buf
+ * and the next block is read after it.
+ * @param src Reads the next block into its argument (returns bytes, 0 at end)
+ */
+static void ingest(ssize_t (*src)(uint8_t*)){
+    static uint8_t buf[MAX_RECORD + READ_SIZE];
+    size_t keep = 0, total;
+    ssize_t r;
+
+    while((r = src(buf + keep)) > 0){
+        total = keep + r;
+        keep = decode(buf, total);
+        memmove(buf, buf + total - keep, keep);
+    }
+}
+
+static void finish(void){
+    if(out_fmt == OUT_COL)
+        col_flush();
+    out_flush();
+}
+
+static void reset(void){
+    binary = 0;
+    cur.nv = 0;
+    text_seq = 0;
+    samples = bad = skipped = lost = 0;
+    have_seq = 0;
+    col_rows = 0;
+    out_len = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// Sources
+// -----------------------------------------------------------------------------
+
+static int in_fd;
+static const uint8_t *mem;              // Benchmark capture
+static size_t mem_len, mem_pos;
+
+static ssize_t read_fd(uint8_t *dest){
+    return read(in_fd, dest, READ_SIZE);
+}
+
+static ssize_t read_mem(uint8_t *dest){
+    size_t n = mem_len - mem_pos;
+    if(n > READ_SIZE)
+        n = READ_SIZE;
+    memcpy(dest, mem + mem_pos, n);
+    mem_pos += n;
+    return n;
+}
+
+static int open_input(const char *path, long baud){
+    struct termios t;
+    speed_t speed = baud == 115200 ? B115200 : baud == 57600 ? B57600 :
+            baud == 38400 ? B38400 : baud == 19200 ? B19200 : B9600;
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if(fd >= 0 && isatty(fd) && tcgetattr(fd, &t) == 0){
+        cfmakeraw(&t);
+        cfsetispeed(&t, speed);
+        cfsetospeed(&t, speed);
+        t.c_cc[VMIN] = 1;               // Block for data, then take all there is
+        t.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    return fd;
+}
+
+
+// -----------------------------------------------------------------------------
+// Synthetic capture and benchmark
+// -----------------------------------------------------------------------------
+
+static void generate(int bin, unsigned long count){
+    uint8_t raw[FRAME_HEADER_SIZE + 10 + FRAME_CRC_SIZE], enc[64];
+    unsigned long i;
+    unsigned int j, plen;
+    int32_t v[5];
+    char *p;
+
+    if(bin)
+        out_bytes("\0", 1);             // As sent by the 'B' command
+    for(i = 0; i < count; ++i){
+        v[0] = (int32_t)(i % 5000) - 1000;  // -10.00 to 39.99
+        v[1] = 4000 + (i * 7) % 3000;
+        v[2] = v[0] - 800;
+        v[3] = 1000 + i % 500;
+        v[4] = v[0] + 50;
+        plen = (i % 4 == 0) ? 10 : 4;   // Some with derived values
+        if(!bin){
+            if(out_len + 128 > sizeof(out_buf))
+                out_flush();
+            p = out_buf + out_len;
+            for(j = 0; j < plen / 2; ++j){
+                memcpy(p, j < 2 ? (j ? "H: " : "T: ") : j == 2 ? "DP: " : j == 3 ? "AH: " : "HI: ",
+                        j < 2 ? 3 : 4);
+                p += j < 2 ? 3 : 4;
+                p = put_fixed(p, v[j]);
+                *p++ = '\r';
+                *p++ = '\n';
+            }
+            *p++ = '\r';
+            *p++ = '\n';
+            out_len = p - out_buf;
+            continue;
+        }
+        raw[0] = FRAME_SAMPLE;
+        raw[1] = i & 0xFF;
+        hostframe_put32(&raw[2], i * 500);
+        for(j = 0; j < plen / 2; ++j)
+            hostframe_put16(&raw[FRAME_HEADER_SIZE + 2 * j], v[j]);
+        out_bytes(enc, hostframe_encode(raw, FRAME_HEADER_SIZE + plen, enc));
+    }
+    out_flush();
+}
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int benchmark(const char *path){
+    static const char *fmts[] = { "csv", "col", "none" };
+    struct stat st;
+    uint8_t *data;
+    double t, best = 1e30;
+    int fd, run;
+
+    fd = open(path, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) != 0){
+        perror(path);
+        return 1;
+    }
+    data = malloc(st.st_size + 1);
+    if(data == NULL || read(fd, data, st.st_size) != st.st_size){
+        perror(path);
+        return 1;
+    }
+    close(fd);
+    mem = data;
+    mem_len = st.st_size;
+
+    out_discard = 1;
+    for(run = 0; run < 5; ++run){
+        reset();
+        mem_pos = 0;
+        t = now_s();
+        ingest(read_mem);
+        finish();
+        t = now_s() - t;
+        if(t < best)
+            best = t;
+    }
+    printf("%s: %lu samples, %lu bytes, %lu bad, %lu skipped, output %s\n",
+            path, samples, (unsigned long)mem_len, bad, skipped, fmts[out_fmt]);
+    printf("best of 5: %.2f ms, %.0f samples/s, %.1f MB/s\n", best * 1000,
+            samples / best, mem_len / best / 1e6);
+    free(data);
+    return 0;
+}
+
+
+int main(int argc, char **argv){
+    const char *out_path = NULL, *gen = NULL;
+    unsigned long count = 1000000;
+    long baud = 9600;
+    int opt, bench = 0;
+
+    while((opt = getopt(argc, argv, "f:o:s:g:n:B")) != -1){
+        switch(opt){
+        case 'f':
+            if(strcmp(optarg, "csv") == 0)
+                out_fmt = OUT_CSV;
+            else if(strcmp(optarg, "col") == 0)
+                out_fmt = OUT_COL;
+            else if(strcmp(optarg, "none") == 0)
+                out_fmt = OUT_NONE;
+            else
+                goto usage;
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        case 's':
+            baud = atol(optarg);
+            break;
+        case 'g':
+            gen = optarg;
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 10);
+            break;
+        case 'B':
+            bench = 1;
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if(out_path != NULL){
+        out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(out_fd < 0){
+            perror(out_path);
+            return 1;
+        }
+    }
+    if(gen != NULL){
+        generate(strcmp(gen, "bin") == 0, count);
+        return 0;
+    }
+    if(bench){
+        if(optind >= argc)
+            goto usage;
+        return benchmark(argv[optind]);
+    }
+
+    in_fd = 0;
+    if(optind < argc){
+        in_fd = open_input(argv[optind], baud);
+        if(in_fd < 0){
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if(out_fmt == OUT_CSV)
+        out_bytes(CSV_HEADER, sizeof(CSV_HEADER) - 1);
+    ingest(read_fd);
+    finish();
+    fprintf(stderr, "ingest: %lu samples, %lu bad, %lu lost, %lu skipped\n",
+            samples, bad, lost, skipped);
+    return 0;
+
+usage:
+    fprintf(stderr, "Usage: ingest [-f csv|col|none] [-o file] [-s baud] [input]\n"
+            "       ingest -g text|bin [-n samples] [-o file]\n"
+            "       ingest -B [-f csv|col|none] capture\n");
+    return 1;
+}
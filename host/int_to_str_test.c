@@ -0,0 +1,130 @@
+/**
+ * @file int_to_str_test.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Exhaustive check and benchmark of uint16_to_str and int16_to_str (16-bit
+ * udiv10_16) against int_to_str (32-bit udiv10) and printf.
+ *
+ * Build (Linux): cc -O2 -I../include -o int_to_str_test int_to_str_test.c ../src/msp430helper.c
+ * Usage: int_to_str_test [rounds]      (default 50, best of 5 runs)
+ *
+ * Every uint16_t and int16_t value is checked with the 16-bit functions and
+ * int_to_str, and int_to_str is also checked across the 32-bit range. The MSP430 has no barrel
+ * shifter, so each 32-bit shift in udiv10 costs two instructions per bit
+ * against one for udiv10_16; the gain there is larger than on the host.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <msp430helper.h>
+
+#define MAX16               65535
+
+
+// Same signature as int_to_str (values are in range of the 16-bit type)
+static unsigned int u16(int32_t value, char *data){
+    return uint16_to_str(value, data);
+}
+
+static unsigned int s16(int32_t value, char *data){
+    return int16_to_str(value, data);
+}
+
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long check(const char *name, unsigned int (*conv)(int32_t, char*), int32_t v){
+    char expect[16], got[16];
+    unsigned int len;
+    snprintf(expect, sizeof(expect), "%+ld", (long)v);
+    memset(got, 'x', sizeof(got));
+    len = conv(v, got);
+    if(strcmp(expect, got) != 0 || len != strlen(expect)){
+        fprintf(stderr, "int_to_str_test: %s(%ld) = \"%s\" (%u)\n", name, (long)v, got, len);
+        return 1;
+    }
+    return 0;
+}
+
+static double bench(unsigned int (*conv)(int32_t, char*), int32_t min, int32_t max,
+        unsigned int rounds){
+    char buf[16];
+    volatile unsigned int sink = 0;
+    double t, best = 1e9;
+    unsigned int run, r;
+    int32_t v;
+    for(run = 0; run < 5; ++run){
+        t = now();
+        for(r = 0; r < rounds; ++r)
+            for(v = min; v <= max; ++v)
+                sink += conv(v, buf);
+        t = (now() - t) * 1e9 / ((double)rounds * (max - min + 1));
+        if(t < best)
+            best = t;
+    }
+    return best;
+}
+
+int main(int argc, char **argv){
+    unsigned int rounds = 50;
+    unsigned long bad = 0;
+    int64_t v;
+
+    if(argc > 1)
+        rounds = strtoul(argv[1], NULL, 0);
+
+    for(v = 0; v <= MAX16; ++v){
+        bad += check("uint16_to_str", u16, v);
+        bad += check("int16_to_str", s16, (int16_t)v);
+        bad += check("int_to_str", int_to_str, v);
+        bad += check("int_to_str", int_to_str, -v);
+    }
+    for(v = INT32_MIN + 1; v <= INT32_MAX; v += 9973)
+        bad += check("int_to_str", int_to_str, v);
+    bad += check("int_to_str", int_to_str, INT32_MAX);
+    if(bad){
+        printf("FAIL: %lu mismatches\n", bad);
+        return 1;
+    }
+
+    printf("int_to_str    (udiv10)     %6.1f ns/value\n", bench(int_to_str, 0, MAX16, rounds));
+    printf("uint16_to_str (udiv10_16)  %6.1f ns/value\n", bench(u16, 0, MAX16, rounds));
+    printf("int_to_str    (udiv10)     %6.1f ns/value (signed)\n",
+            bench(int_to_str, INT16_MIN, INT16_MAX, rounds));
+    printf("int16_to_str  (udiv10_16)  %6.1f ns/value\n", bench(s16, INT16_MIN, INT16_MAX, rounds));
+    printf("PASS\n");
+    return 0;
+}
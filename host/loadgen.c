@@ -0,0 +1,236 @@
+/**
+ * @file loadgen.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Load generator for aggregate: simulates many boards, each streaming samples
+ * on its own pty in the device's text ("T:"/"H:") or binary frame format.
+ * Slave pty paths are printed one per line once all are open.
+ *
+ * Build (Linux): cc -O2 -I../include -o loadgen loadgen.c hostframe.c
+ * Usage: loadgen [-n boards] [-r samples/s per board] [-b binary_percent]
+ *                [-d drift_ppm] [-R reset_s] [-t seconds] [-l listfile]
+ *                      (default 100 boards, 1/s, 50%, no drift or resets, forever)
+ *
+ * Boards start at random phases and boot times. With -d each board's clock
+ * runs off by a random amount up to drift_ppm either way, and with -R boards
+ * reset (timestamp and sequence number back to 0, format kept) at random
+ * intervals averaging reset_s. Writes never block: if a pty is full (reader
+ * too slow) the sample is dropped and counted. Totals are printed on stderr
+ * at exit.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <frame.h>
+#include "hostframe.h"
+
+typedef struct {
+    int master;
+    int slave;                          // Kept open so writes never hang up
+    int binary;
+    uint8_t seq;
+    uint32_t boot_ms;                   // Device timers_now at start
+    uint64_t boot_us;                   // Host time of start (or last reset)
+    int32_t drift_ppm;                  // Device clock error
+    uint64_t reset_us;                  // Next reset (0 if none)
+    uint64_t next_us;                   // Next sample due
+    unsigned long n;
+} board;
+
+static volatile sig_atomic_t stop;
+static unsigned long written, dropped, bytes, resets;
+
+
+static void on_signal(int sig){
+    (void)sig;
+    stop = 1;
+}
+
+static uint64_t now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static char *put_fixed(char *p, int32_t v){
+    uint32_t m = v < 0 ? -(uint32_t)v : (uint32_t)v;
+    if(v < 0)
+        *p++ = '-';
+    return p + sprintf(p, "%u.%02u", m / 100, m % 100);
+}
+
+// One sample in the board's format. Returns length.
+static size_t make_sample(board *b, uint32_t ms, uint8_t *out){
+    uint8_t raw[FRAME_HEADER_SIZE + 4 + FRAME_CRC_SIZE];
+    int32_t t = 2000 + (int32_t)(b->n % 200) - 100, h = 4500 + b->n % 300;
+    char *p;
+
+    if(!b->binary){
+        p = (char*)out;
+        p = put_fixed(p + sprintf(p, "T: "), t);
+        p = put_fixed(p + sprintf(p, "\r\nH: "), h);
+        p += sprintf(p, "\r\n\r\n");
+        return p - (char*)out;
+    }
+    raw[0] = FRAME_SAMPLE;
+    raw[1] = b->seq++;
+    hostframe_put32(&raw[2], ms);
+    hostframe_put16(&raw[6], t);
+    hostframe_put16(&raw[8], h);
+    return hostframe_encode(raw, FRAME_HEADER_SIZE + 4, out);
+}
+
+int main(int argc, char **argv){
+    int count = 100, bin_pct = 50, drift = 0, opt, i;
+    double rate = 1, seconds = 0, reset = 0;
+    uint32_t ms;
+    const char *list = NULL;
+    uint64_t start, period, now, end = 0, next;
+    struct termios t;
+    struct timespec ts;
+    uint8_t buf[64];
+    board *boards;
+    FILE *lf = stdout;
+    size_t len;
+    ssize_t r;
+
+    while((opt = getopt(argc, argv, "n:r:b:d:R:t:l:")) != -1){
+        switch(opt){
+        case 'n': count = atoi(optarg); break;
+        case 'r': rate = atof(optarg); break;
+        case 'b': bin_pct = atoi(optarg); break;
+        case 'd': drift = atoi(optarg); break;
+        case 'R': reset = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        case 'l': list = optarg; break;
+        default:
+            fprintf(stderr, "Usage: loadgen [-n boards] [-r rate] [-b binary_percent] "
+                    "[-d drift_ppm] [-R reset_s] [-t seconds] [-l listfile]\n");
+            return 1;
+        }
+    }
+    if(count < 1 || rate <= 0 || drift < 0 || reset < 0)
+        return 1;
+    period = (uint64_t)(1e6 / rate);
+    boards = calloc(count, sizeof(board));
+    if(boards == NULL)
+        return 1;
+    if(list != NULL && (lf = fopen(list, "w")) == NULL){
+        perror(list);
+        return 1;
+    }
+
+    srand(1);
+    start = now_us();
+    for(i = 0; i < count; ++i){
+        board *b = &boards[i];
+        b->master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if(b->master < 0 || grantpt(b->master) != 0 || unlockpt(b->master) != 0 ||
+                (b->slave = open(ptsname(b->master), O_RDWR | O_NOCTTY)) < 0){
+            perror("loadgen: pty");
+            return 1;
+        }
+        tcgetattr(b->slave, &t);
+        cfmakeraw(&t);                  // Raw before any reader opens it
+        tcsetattr(b->slave, TCSANOW, &t);
+        b->binary = (i * 100 / count) < bin_pct;
+        b->boot_ms = rand() % 100000;
+        b->boot_us = start;
+        b->drift_ppm = drift ? rand() % (2 * drift + 1) - drift : 0;
+        if(reset > 0)
+            b->reset_us = start + (uint64_t)(reset * 2e6 * rand() / RAND_MAX);
+        b->next_us = start + (uint64_t)rand() % period;
+        fprintf(lf, "%s\n", ptsname(b->master));
+    }
+    if(lf != stdout)
+        fclose(lf);
+    fflush(stdout);
+    fprintf(stderr, "loadgen: %d boards (%d binary), %.1f samples/s each\n",
+            count, (count * bin_pct + 99) / 100, rate);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    if(seconds > 0)
+        end = now_us() + (uint64_t)(seconds * 1e6);
+
+    while(!stop){
+        now = now_us();
+        if(end != 0 && now >= end)
+            break;
+        next = now + 10000;
+        for(i = 0; i < count; ++i){
+            board *b = &boards[i];
+            while(b->next_us <= now){
+                if(b->binary && b->n == 0){
+                    if(write(b->master, "", 1) == 1)    // As sent by 'B'
+                        bytes++;
+                }
+                if(b->reset_us != 0 && b->next_us >= b->reset_us){
+                    b->boot_ms = 0;
+                    b->boot_us = b->next_us;
+                    b->seq = 0;
+                    b->reset_us = b->next_us + (uint64_t)(reset * 2e6 * rand() / RAND_MAX);
+                    resets++;
+                }
+                ms = b->boot_ms + (b->next_us - b->boot_us) * (1000000 + b->drift_ppm) / 1000000000;
+                len = make_sample(b, ms, buf);
+                r = write(b->master, buf, len);
+                if(r == (ssize_t)len){
+                    written++;
+                    bytes += len;
+                }else{
+                    dropped++;          // Reader not keeping up
+                    if(r < 0 && errno != EAGAIN)
+                        stop = 1;
+                }
+                b->n++;
+                b->next_us += period;
+            }
+            if(b->next_us < next)
+                next = b->next_us;
+        }
+        ts.tv_sec = next / 1000000;
+        ts.tv_nsec = (next % 1000000) * 1000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    fprintf(stderr, "loadgen: %lu samples (%lu bytes) written, %lu dropped, %lu resets in %.1fs\n",
+            written, bytes, dropped, resets, (now_us() - start) / 1e6);
+    return 0;
+}
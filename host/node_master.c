@@ -0,0 +1,197 @@
+/**
+ * @file node_master.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Poll boards in RS-485 polled mode (see include/node.h) and report the
+ * polling cycle time of the chain. Each cycle reads all registers of node IDs
+ * 1 to N in turn; a node that does not reply within the timeout is skipped.
+ * Works on a serial port (through an RS-485 adapter that switches direction
+ * itself) or the pty printed by node_sim.
+ *
+ * Build (Linux): cc -O2 -I../include -o node_master node_master.c hostframe.c
+ * Usage: node_master device [nodes] [cycles] [baud] [timeout_ms]
+ *                                      (default 8 nodes, 20 cycles, 9600, 100)
+ *
+ * The last reading of each node is printed as CSV:
+ *   id,temperature,humidity,age_ms,status,alarm,count
+ * followed by cycle time statistics and the time the bytes alone need on the
+ * line at the baud rate. After each reply the master waits one byte time
+ * before the next request so the node can release the line.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <node.h>
+#include "hostframe.h"
+
+#define MAX_NODES           NODE_ID_MAX
+#define MAX_FRAME           64
+
+
+static uint16_t regs[MAX_NODES + 1][NODE_REGS];
+static int have[MAX_NODES + 1];
+static unsigned long timeouts, bad;
+
+
+static uint64_t now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int open_port(const char *path, long baud){
+    struct termios t;
+    speed_t speed = baud == 115200 ? B115200 : baud == 57600 ? B57600 :
+            baud == 38400 ? B38400 : baud == 19200 ? B19200 : B9600;
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if(fd < 0)
+        return -1;
+    if(tcgetattr(fd, &t) == 0){
+        cfmakeraw(&t);
+        cfsetispeed(&t, speed);
+        cfsetospeed(&t, speed);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/**
+ * Read all registers of one node
+ * @return Reply bytes on the line (encoded) or 0 on timeout / bad reply
+ */
+static size_t poll_node(int fd, uint8_t id, int timeout_ms){
+    uint8_t req[4 + FRAME_CRC_SIZE], enc[MAX_FRAME];
+    size_t len = 0;
+    uint64_t end;
+    struct pollfd p = { fd, POLLIN, 0 };
+    int n, i, left;
+    uint8_t b;
+
+    req[0] = id;
+    req[1] = NODE_FN_READ;
+    req[2] = 0;                         // First register
+    req[3] = NODE_REGS;
+    n = hostframe_encode(req, 4, enc);
+    tcflush(fd, TCIFLUSH);              // Late reply after a timeout
+    if(write(fd, enc, n) != n)
+        return 0;
+
+    end = now_us() + (uint64_t)timeout_ms * 1000;
+    for(;;){
+        left = (int)(((int64_t)(end - now_us())) / 1000);
+        if(left < 0 || poll(&p, 1, left) <= 0){
+            timeouts++;
+            return 0;
+        }
+        if(read(fd, &b, 1) != 1)
+            continue;
+        if(b != 0){
+            if(len < sizeof(enc))
+                enc[len++] = b;
+            continue;
+        }
+        // Delimiter. Echo of own request (some adapters) or a full reply.
+        n = hostframe_decode(enc, len);
+        if(n == 4 && enc[0] == id){
+            len = 0;
+            continue;
+        }
+        if(n != 3 + 2 * NODE_REGS || enc[0] != (id | NODE_REPLY) ||
+                enc[1] != NODE_FN_READ || enc[2] != NODE_REGS){
+            bad++;
+            return 0;
+        }
+        for(i = 0; i < NODE_REGS; ++i)
+            regs[id][i] = hostframe_get16(&enc[3 + 2 * i]);
+        have[id] = 1;
+        return len + 1;
+    }
+}
+
+int main(int argc, char **argv){
+    int nodes = argc > 2 ? atoi(argv[2]) : 8;
+    int cycles = argc > 3 ? atoi(argv[3]) : 20;
+    long baud = argc > 4 ? atol(argv[4]) : 9600;
+    int timeout = argc > 5 ? atoi(argv[5]) : 100;
+    uint64_t byte_us = 10000000 / baud, start, t, min = UINT64_MAX, max = 0, sum = 0;
+    uint64_t line_bytes = 0, guard;
+    int fd, cycle, id;
+    size_t n;
+
+    if(argc < 2 || nodes < 1 || nodes > MAX_NODES || cycles < 1){
+        fprintf(stderr, "Usage: node_master device [nodes] [cycles] [baud] [timeout_ms]\n");
+        return 1;
+    }
+    fd = open_port(argv[1], baud);
+    if(fd < 0){
+        perror(argv[1]);
+        return 1;
+    }
+
+    for(cycle = 0; cycle < cycles; ++cycle){
+        start = now_us();
+        for(id = 1; id <= nodes; ++id){
+            n = poll_node(fd, id, timeout);
+            line_bytes += 8 + n;        // Request is 8 bytes encoded
+            guard = now_us() + byte_us; // Let the node release the line
+            while(now_us() < guard);
+        }
+        t = now_us() - start;
+        sum += t;
+        if(t < min)
+            min = t;
+        if(t > max)
+            max = t;
+    }
+
+    printf("id,temperature,humidity,age_ms,status,alarm,count\n");
+    for(id = 1; id <= nodes; ++id){
+        if(!have[id]){
+            printf("%d,,,,,,\n", id);
+            continue;
+        }
+        printf("%d,%.2f,%.2f,%u,%u,%u,%u\n", id, (int16_t)regs[id][0] / 100.0,
+                regs[id][1] / 100.0, regs[id][2], regs[id][3], regs[id][4], regs[id][5]);
+    }
+    fprintf(stderr, "%d nodes, %d cycles, %ld baud: cycle %.1f ms avg (%.1f min, %.1f max), "
+            "%.1f ms per node\n", nodes, cycles, baud, sum / 1000.0 / cycles,
+            min / 1000.0, max / 1000.0, sum / 1000.0 / cycles / nodes);
+    fprintf(stderr, "bytes on line alone: %.1f ms per cycle; %lu timeouts, %lu bad replies\n",
+            line_bytes * byte_us / 1000.0 / cycles, timeouts, bad);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file node_sim.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Simulate a chain of boards in RS-485 polled mode (see include/node.h) on a
+ * pty, for testing a master such as node_master. Each node is a child process
+ * running the real node protocol and uca0uart code (registers simulated, see
+ * sim/msp430.h) with made up sensor values. The parent is the shared line:
+ * every byte from the master goes to all nodes and node replies go to the
+ * master, each delayed by one byte time at the given baud rate so timing is
+ * close to a real line.
+ *
+ * Build (Linux): cc -O2 -D_GNU_SOURCE -I../include -Isim -include sim/msp430.h -DNODE_FLASH=sim_flash -o node_sim node_sim.c ../src/node.c ../src/frame.c ../src/uca0uart.c ../src/spsc_buffer.c ../src/rings.c ../src/fmt.c ../src/msp430helper.c
+ * Usage: node_sim [nodes] [baud]       (default 8, 9600; prints pty path)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <node.h>
+#include <uca0uart.h>
+#include <timers.h>
+#include <aht10.h>
+#include <alarm.h>
+#include <msp430.h>
+
+#define MAX_NODES           64
+
+// Simulated registers (see sim/msp430.h)
+volatile uint8_t P1OUT;
+volatile uint8_t IE2, IFG2;
+volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0MCTL;
+volatile uint8_t UCA0TXBUF, UCA0RXBUF, UCA0STAT;
+
+// Globals node.c uses from other modules
+volatile uint32_t timers_now;
+int16_t aht10_temperature;
+unsigned int aht10_humidity;
+uint8_t aht10_ec;
+uint8_t alarm_state;
+
+// Info flash segment C (see sim/msp430.h)
+uint16_t sim_flash[32];
+
+void flash_erase(const void *addr){
+    memset((void*)addr, 0xFF, sizeof(sim_flash));
+}
+
+void flash_write(const void *dest, const uint16_t *src, unsigned int count){
+    memcpy((void*)dest, src, count * 2);
+}
+
+
+static uint64_t now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_until(uint64_t us){
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+// One board. Reads line bytes from in, writes its transmitted bytes to out.
+static void run_node(uint8_t id, int in, int out){
+    uint8_t buf[256], tx[64];
+    uint64_t start = now_us(), next_sample = 0;
+    unsigned int n, i, len;
+    ssize_t r;
+
+    uca0uart_init(uca0uart_BUAD_9600);
+    node_store(id);                     // Goes to sim_flash
+    node_init();                        // Loaded back from sim_flash
+
+    while((r = read(in, buf, sizeof(buf))) > 0){
+        timers_now = (now_us() - start) / 1000;
+        while(timers_now >= next_sample){
+            // A conversion every 500ms, values differ per node
+            n = next_sample / 500;
+            aht10_temperature = 2000 + id * 10 + n % 50;
+            aht10_humidity = 4000 + id * 20 + n % 30;
+            node_sample();
+            next_sample += 500;
+        }
+        for(i = 0; i < (unsigned int)r; ++i){
+            UCA0RXBUF = buf[i];         // RX ISR
+            uca0uart_handle_read();
+            node_poll();                // Main loop (UART_RX flag)
+            for(len = 0; (IE2 & UCA0TXIE) && len < sizeof(tx); ++len){
+                uca0uart_handle_write();// TX ISR
+                tx[len] = UCA0TXBUF;
+            }
+            if(len != 0 && write(out, tx, len) != (ssize_t)len)
+                exit(1);
+        }
+    }
+    exit(0);
+}
+
+int main(int argc, char **argv){
+    int nodes = argc > 1 ? atoi(argv[1]) : 8;
+    long baud = argc > 2 ? atol(argv[2]) : 9600;
+    int pty, to_nodes[MAX_NODES], from_nodes[2], p[2], i;
+    uint64_t byte_us = 10000000 / baud, wire = 0;
+    struct pollfd fds[2];
+    uint8_t buf[256];
+    ssize_t r, j;
+
+    if(nodes < 1 || nodes > MAX_NODES || nodes > NODE_ID_MAX || baud <= 0){
+        fprintf(stderr, "node_sim: 1 to %d nodes\n", MAX_NODES);
+        return 1;
+    }
+    pty = posix_openpt(O_RDWR | O_NOCTTY);
+    if(pty < 0 || grantpt(pty) != 0 || unlockpt(pty) != 0){
+        perror("node_sim: pty");
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if(pipe(from_nodes) != 0)
+        return 1;
+    for(i = 0; i < nodes; ++i){
+        if(pipe(p) != 0)
+            return 1;
+        if(fork() == 0){
+            close(pty);
+            close(p[1]);
+            close(from_nodes[0]);
+            run_node(i + 1, p[0], from_nodes[1]);
+        }
+        close(p[0]);
+        to_nodes[i] = p[1];
+    }
+    close(from_nodes[1]);
+
+    printf("%s\n", ptsname(pty));
+    printf("%d nodes (IDs 1 to %d), %ld baud\n", nodes, nodes, baud);
+    fflush(stdout);
+
+    fds[0].fd = pty;
+    fds[0].events = POLLIN;
+    fds[1].fd = from_nodes[0];
+    fds[1].events = POLLIN;
+    while(poll(fds, 2, -1) > 0){
+        // Half duplex: bytes from either side use the line in turn
+        for(i = 0; i < 2; ++i){
+            if(!(fds[i].revents & (POLLIN | POLLHUP)))
+                continue;
+            r = read(fds[i].fd, buf, sizeof(buf));
+            if(r <= 0){
+                if(i == 1)
+                    return 0;           // Nodes gone
+                usleep(10000);          // No master opened the pty yet
+                continue;
+            }
+            for(j = 0; j < r; ++j){
+                if(wire < now_us())
+                    wire = now_us();
+                wire += byte_us;
+                sleep_until(wire);      // Byte has crossed the line
+                if(i == 0){
+                    for(p[0] = 0; p[0] < nodes; ++p[0]){
+                        if(write(to_nodes[p[0]], &buf[j], 1) != 1)
+                            return 1;
+                    }
+                }else if(write(pty, &buf[j], 1) != 1){
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
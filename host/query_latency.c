@@ -0,0 +1,198 @@
+/**
+ * @file query_latency.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Simulate query-to-response latency of the '?' (last conversion) and '!'
+ * (new conversion) commands. The real command parser and uca0uart buffers
+ * (through the simulated registers in sim/msp430.h) carry the bytes; UART
+ * byte times, bbi2c transaction times and the AHT10 conversion time are
+ * modelled in 1us steps. Latency is measured from the start bit of the query
+ * byte to the end of the last byte of the "Q:" reply.
+ *
+ * Build (Linux): cc -O2 -I../include -Isim -o query_latency query_latency.c ../src/command.c ../src/uca0uart.c ../src/spsc_buffer.c ../src/rings.c ../src/fmt.c ../src/msp430helper.c
+ * Usage: query_latency [conversion_ms] [baud]    (default 75, 9600)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <command.h>
+#include <uca0uart.h>
+#include <msp430.h>
+
+// bbi2c: 50kHz (20us per bit). Start + stop counted as 2 bits.
+#define I2C_BIT_US          20
+#define I2C_US(bytes)       ((((bytes) + 1) * 9 + 2) * I2C_BIT_US)
+#define TRIGGER_US          I2C_US(3)   // Trigger command
+#define STATUS_US           I2C_US(1)   // One status poll
+#define DATA_US             I2C_US(6)   // Read raw data
+
+// Main loop time to handle a flag (wake, parse, format reply). Estimate.
+#define MAIN_US             50
+
+#define REPORT_LINE_MAX     26          // Space print_query waits for (main.c)
+
+// Simulated registers (see sim/msp430.h)
+volatile uint8_t P1OUT;
+volatile uint8_t IE2, IFG2;
+volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0MCTL;
+volatile uint8_t UCA0TXBUF, UCA0RXBUF, UCA0STAT;
+
+// Sensor model
+static long conv_us;                    // AHT10 conversion time
+static long sensor_done;                // Time conversion data is read (-1 idle)
+static long sample_time;                // Time of last completed conversion
+static int query_pending;
+
+static long byte_us;                    // UART time per byte (8N1)
+static long now;                        // Current time (us)
+
+
+// Same text as print_query in main.c
+static void print_query(void){
+    long age = (now - sample_time) / 10000 * 10; // timers_now is 10ms steps
+    uca0uart_write_str("Q: ");
+    uca0uart_write_fixed(age, 0, 0);
+    uca0uart_write_byte(' ');
+    uca0uart_write_fixed(2345, 2, 0);
+    uca0uart_write_byte(' ');
+    uca0uart_write_fixed(4567, 2, 0);
+    uca0uart_write_str("\r\n");
+}
+
+// AHT10 read started now (or at start). Status polls back to back until the
+// conversion is done, then the data is read.
+static long sensor_finish(long start){
+    long t = start + TRIGGER_US;
+    do{
+        t += STATUS_US;
+    }while(t < start + TRIGGER_US + conv_us);
+    return t + DATA_US;
+}
+
+/**
+ * Run one scenario
+ * @param cmd Query byte
+ * @param backlog Bytes already queued for TX when the query is sent
+ * @param busy_ms Conversion started this long before the query (-1 if idle)
+ * @return Latency in us (-1 if no reply)
+ */
+static long run(uint8_t cmd, unsigned int backlog, long busy_ms){
+    const long query_at = 1000000;      // Leave time for an older conversion
+    long tx_end = 0, rx_done = query_at + byte_us;
+    long cmd_at = -1, reply_at = -1;    // Main loop handles command / sample
+    unsigned int i;
+    command c;
+
+    uca0uart_init(uca0uart_BUAD_9600);
+    command_init();
+    query_pending = 0;
+    sample_time = query_at - 300000;    // Last periodic sample 300ms ago
+    sensor_done = busy_ms < 0 ? -1 : sensor_finish(query_at - busy_ms * 1000);
+
+    for(now = query_at - 1; now < query_at + 2000000; ++now){
+        if(now == query_at - 1){
+            for(i = 0; i < backlog; ++i)
+                uca0uart_write_byte('.');       // Periodic output ahead
+        }
+        if(now == rx_done){
+            UCA0RXBUF = cmd;                    // RX ISR
+            uca0uart_handle_read();
+            cmd_at = now + MAIN_US;
+        }
+        if(now == sensor_done){
+            sensor_done = -1;                   // bbi2c done
+            sample_time = now;
+            if(query_pending){
+                query_pending = 0;
+                reply_at = now + MAIN_US;       // handle_sample
+            }
+        }
+        if(now == cmd_at && command_next(&c)){
+            if(c.id == '?'){
+                reply_at = now;
+            }else{
+                query_pending = 1;
+                if(sensor_done < 0)
+                    sensor_done = sensor_finish(now);
+            }
+        }
+        if(now == reply_at){
+            if(uca0uart_write_avail() < REPORT_LINE_MAX)
+                reply_at = now + byte_us;       // uca0uart_wait_avail (LPM0)
+            else
+                print_query();
+        }
+        if(now >= tx_end && (IE2 & UCA0TXIE)){
+            uca0uart_handle_write();            // TX ISR
+            tx_end = now + byte_us;
+            if(UCA0TXBUF == '\n')
+                return tx_end - query_at;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char **argv){
+    long baud = 9600;
+    static const struct {
+        const char *name;
+        uint8_t cmd;
+        unsigned int backlog;
+        long busy_ms;
+    } cases[] = {
+        { "'?' idle link",                      '?', 0,  -1 },
+        { "'?' behind one sample print (22B)",  '?', 22, -1 },
+        { "'?' behind full write buffer (32B)", '?', 32, -1 },
+        { "'!' sensor idle",                    '!', 0,  -1 },
+        { "'!' conversion started 50ms before", '!', 0,  50 },
+        { "'!' behind one sample print (22B)",  '!', 22, -1 },
+    };
+    unsigned int i;
+    long us;
+
+    conv_us = (argc > 1 ? atol(argv[1]) : 75) * 1000;
+    if(argc > 2)
+        baud = atol(argv[2]);
+    byte_us = 10000000L / baud;
+
+    printf("conversion %ldms, %ld baud (%ldus per byte), I2C trigger %dus, "
+            "status %dus, data %dus\n", conv_us / 1000, baud, byte_us,
+            TRIGGER_US, STATUS_US, DATA_US);
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i){
+        us = run(cases[i].cmd, cases[i].backlog, cases[i].busy_ms);
+        if(us < 0)
+            printf("%-38s no reply\n", cases[i].name);
+        else
+            printf("%-38s %7.2f ms\n", cases[i].name, us / 1000.0);
+    }
+    return 0;
+}
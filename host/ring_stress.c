@@ -0,0 +1,231 @@
+/**
+ * @file ring_stress.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Test the macro-generated ring (include/ring.h): full / empty and counts,
+ * index wrap (including the head / tail counters overflowing), then a stress
+ * run with one side in a signal handler, which preempts the main loop at
+ * arbitrary instructions like an ISR would.
+ *
+ * Build (Linux): cc -O2 -I../include -o ring_stress ring_stress.c
+ * Usage: ring_stress [seconds]         (default 5, split between both tests)
+ *
+ * TX test: main loop produces (reserve / commit and push), "ISR" consumes
+ * (peek / release and pop). RX test: the other way around. Every record
+ * carries a sequence number and its complement so loss, duplication,
+ * reordering and records published before they were filled are detected.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <ring.h>
+
+#define CAPACITY            4           // Small so wrap happens often
+#define TIMER_US            5           // Signal interval (as fast as allowed)
+
+typedef struct {
+    uint16_t seq;
+    uint16_t check;                     // ~seq
+} record;
+
+RING_DECLARE(test_ring, record, CAPACITY)
+RING_DEFINE(test_ring, record, CAPACITY)
+
+
+static test_ring ring;
+static volatile sig_atomic_t rx_test;
+static volatile uint16_t isr_seq;       // Next record "ISR" produces / expects
+static volatile unsigned long isr_records, isr_calls, errors;
+
+
+static void fail(const char *msg){
+    errors++;
+    if(errors < 10)
+        fprintf(stderr, "ring_stress: %s\n", msg);
+}
+
+static void check(const record *r, uint16_t seq, const char *msg){
+    if(r->seq != seq || (uint16_t)(r->check ^ seq) != 0xFFFF)
+        fail(msg);
+}
+
+// Reserve / commit on odd sequence numbers, push on even ones
+static bool produce(uint16_t seq){
+    record *r, tmp;
+    if(seq & 1){
+        r = test_ring_reserve(&ring);
+        if(r == NULL)
+            return false;
+        r->seq = seq;
+        r->check = ~seq;
+        test_ring_commit(&ring);
+        return true;
+    }
+    tmp.seq = seq;
+    tmp.check = ~seq;
+    return test_ring_push(&ring, &tmp);
+}
+
+// Peek / release on odd sequence numbers, pop on even ones
+static bool consume(uint16_t seq, const char *msg){
+    record *r, tmp;
+    if(seq & 1){
+        r = test_ring_peek(&ring);
+        if(r == NULL)
+            return false;
+        check(r, seq, msg);
+        test_ring_release(&ring);
+        return true;
+    }
+    if(!test_ring_pop(&ring, &tmp))
+        return false;
+    check(&tmp, seq, msg);
+    return true;
+}
+
+static void basic(unsigned int start){
+    unsigned int i, n;
+    uint16_t seq = 0;
+    record tmp;
+
+    // Counters start just below overflow on the second pass
+    test_ring_init(&ring);
+    ring.head = ring.tail = start;
+    if(!RING_EMPTY(&ring) || RING_FULL(&ring) || RING_COUNT(&ring) != 0 ||
+            test_ring_peek(&ring) != NULL || test_ring_pop(&ring, &tmp))
+        fail("new ring not empty");
+
+    for(n = 0; n < 3 * CAPACITY; ++n){
+        for(i = 0; i < CAPACITY; ++i){
+            if(RING_FULL(&ring) || !produce(seq + i))
+                fail("ring full early");
+            if(RING_COUNT(&ring) != i + 1)
+                fail("wrong count while filling");
+        }
+        if(!RING_FULL(&ring) || test_ring_reserve(&ring) != NULL || produce(seq + i))
+            fail("full ring accepted a record");
+        for(i = 0; i < CAPACITY; ++i){
+            if(RING_EMPTY(&ring) || !consume(seq + i, "wrong record after wrap"))
+                fail("ring empty early");
+        }
+        if(!RING_EMPTY(&ring) || consume(seq + i, "record from empty ring"))
+            fail("empty ring returned a record");
+        seq += CAPACITY;
+
+        // Shift start by one so every slot is first / last in turn
+        produce(seq);
+        consume(seq, "wrong record after shift");
+        seq++;
+    }
+
+    // Reserved but not committed slot is not visible
+    if(test_ring_reserve(&ring) == NULL || test_ring_peek(&ring) != NULL)
+        fail("reserved record visible before commit");
+}
+
+static void isr(int sig){
+    unsigned int i;
+    (void)sig;
+    isr_calls++;
+    if(RING_COUNT(&ring) > CAPACITY)
+        fail("count exceeds capacity (isr)");
+    for(i = 0; i < 2; ++i){             // A few records per "interrupt"
+        if(rx_test ? !produce(isr_seq) : !consume(isr_seq, "TX record out of order"))
+            break;
+        isr_seq++;
+        isr_records++;
+    }
+}
+
+static void start_timer(void){
+    struct itimerval it = {{0, TIMER_US}, {0, TIMER_US}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void stop_timer(void){
+    struct itimerval it = {{0, 0}, {0, 0}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void run(int rx, double seconds){
+    uint16_t seq = 0;
+    unsigned long loops = 0;
+    time_t end = time(NULL) + (time_t)seconds;
+
+    test_ring_init(&ring);
+    rx_test = rx;
+    isr_seq = 0;
+    isr_records = 0;
+    isr_calls = 0;
+    start_timer();
+    while(time(NULL) < end){
+        if(RING_COUNT(&ring) > CAPACITY)
+            fail("count exceeds capacity (main)");
+        if(rx ? consume(seq, "RX record out of order") : produce(seq))
+            seq++;
+        loops++;
+    }
+    stop_timer();
+    printf("%s: %lu interrupts, %lu records through isr, %lu main loops\n",
+            rx ? "RX" : "TX", (unsigned long)isr_calls,
+            (unsigned long)isr_records, loops);
+}
+
+int main(int argc, char **argv){
+    double seconds = 5;
+    struct sigaction sa;
+
+    if(argc > 1)
+        seconds = atof(argv[1]);
+
+    basic(0);
+    basic(UINT_MAX - CAPACITY / 2);
+    printf("basic: %s\n", errors ? "errors" : "ok");
+
+    sa.sa_handler = isr;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+
+    run(0, seconds / 2);
+    run(1, seconds / 2);
+
+    if(errors){
+        printf("FAIL: %lu errors\n", (unsigned long)errors);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file msp430.h
+ * @brief Minimal stand-in for the TI device header so uca0uart (and modules
+ * that only use it) can be built on a host. Registers are plain variables the
+ * host program defines and drives (e.g. set UCA0RXBUF then call
+ * uca0uart_handle_read to simulate a received byte).
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Port 1 output (RS485_TXEN) and USCI A0 registers (define in host program)
+extern volatile uint8_t P1OUT;
+extern volatile uint8_t IE2, IFG2;
+extern volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0MCTL;
+extern volatile uint8_t UCA0TXBUF, UCA0RXBUF, UCA0STAT;
+
+#define UCA0RXIE            0x01
+#define UCA0TXIE            0x02
+#define UCA0RXIFG           0x01
+#define UCA0TXIFG           0x02
+
+#define UCSWRST             0x01
+#define UCSYNC              0x01
+#define UCMODE_0            0x00
+#define UCSPB               0x08
+#define UC7BIT              0x10
+#define UCMSB               0x20
+#define UCPEN               0x80
+#define UCSSEL_2            0x80
+#define UCOS16              0x01
+#define UCBUSY              0x01
+
+#define BIT4                0x10
+
+// Info flash segment for node.c (build with -include sim/msp430.h
+// -DNODE_FLASH=sim_flash; define in host program)
+extern uint16_t sim_flash[32];
+
+// Main flash segments for flashlog.c (build with
+// -DFLASHLOG_START='((uintptr_t)sim_main_flash)'; define in host program)
+extern uint16_t sim_main_flash[];
+
+// No low power modes on host
+#define LPM0                ((void)0)
+#define LPM0_EXIT           ((void)0)
@@ -0,0 +1,119 @@
+/**
+ * @file spsc_bench.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Compare spsc_buffer throughput of block copies (spsc_write_block /
+ * spsc_read_block) against per byte calls (spsc_write / spsc_read). Bytes are
+ * moved through the buffer in chunks: write a chunk, then read it back.
+ *
+ * Build (Linux): cc -O2 -I../include -o spsc_bench spsc_bench.c ../src/spsc_buffer.c
+ * Usage: spsc_bench [megabytes]        (default 64, per chunk size and method)
+ *
+ * Host numbers only show the relative cost of the two methods; absolute rates
+ * on the MSP430 are far lower.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <spsc_buffer.h>
+
+#define SIZE                64          // Same as UCA0UART_WB_SIZE
+
+
+static volatile uint8_t array[SIZE];
+static volatile spsc_buffer sb;
+static unsigned long errors;
+
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Move total bytes through the buffer chunk bytes at a time
+ * @param block true for block copies, false for per byte calls
+ * @return Bytes per second
+ */
+static double run(unsigned int chunk, int block, unsigned long total){
+    uint8_t src[SIZE], dest[SIZE];
+    uint8_t seq = 0, expect = 0;
+    unsigned long done;
+    unsigned int i, n;
+    double start;
+
+    spsc_init(&sb, array, SIZE);
+    start = now();
+    for(done = 0; done < total; done += chunk){
+        for(i = 0; i < chunk; ++i)
+            src[i] = seq++;
+        if(block){
+            n = spsc_write_block(&sb, src, chunk);
+            n = spsc_read_block(&sb, dest, n);
+        }else{
+            for(n = 0; n < chunk && spsc_write(&sb, src[n]); ++n);
+            for(n = 0; n < chunk && spsc_read(&sb, &dest[n]); ++n);
+        }
+        if(n != chunk)
+            errors++;
+        for(i = 0; i < n; ++i){
+            if(dest[i] != expect++)
+                errors++;
+        }
+    }
+    return total / (now() - start);
+}
+
+int main(int argc, char **argv){
+    static const unsigned int chunks[] = { 1, 4, 16, SIZE };
+    unsigned long total = 64;
+    double per_byte, blk;
+    unsigned int i;
+
+    if(argc > 1)
+        total = strtoul(argv[1], NULL, 0);
+    total *= 1024 * 1024;
+
+    printf("chunk  per byte (MB/s)  block (MB/s)  speedup\n");
+    for(i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i){
+        per_byte = run(chunks[i], 0, total);
+        blk = run(chunks[i], 1, total);
+        printf("%5u  %15.1f  %12.1f  %6.2fx\n", chunks[i],
+                per_byte / 1e6, blk / 1e6, blk / per_byte);
+    }
+
+    if(errors){
+        printf("FAIL: %lu errors\n", errors);
+        return 1;
+    }
+    return 0;
+}
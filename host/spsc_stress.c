@@ -0,0 +1,178 @@
+/**
+ * @file spsc_stress.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Stress test spsc_buffer with one side running in a signal handler, which
+ * preempts the main loop at arbitrary instructions like an ISR would.
+ *
+ * Build (Linux): cc -O2 -I../include -o spsc_stress spsc_stress.c ../src/spsc_buffer.c
+ * Usage: spsc_stress [seconds]         (default 5, split between both tests)
+ *
+ * TX test: main loop produces (block and span writes), "ISR" consumes bytes.
+ * RX test: "ISR" produces bytes, main loop consumes (block and span reads).
+ * Every byte carries a sequence number so loss, duplication or reordering is
+ * detected. The fill level is checked to never exceed the buffer size.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <spsc_buffer.h>
+
+#define SIZE                8           // Small so wrap happens often
+#define TIMER_US            5           // Signal interval (as fast as allowed)
+
+
+static volatile uint8_t array[SIZE];
+static volatile spsc_buffer sb;
+static volatile sig_atomic_t rx_test;
+static volatile uint8_t isr_seq;        // Next byte "ISR" produces / expects
+static volatile unsigned long isr_bytes, isr_calls, errors;
+
+
+static void fail(const char *msg){
+    errors++;
+    if(errors < 10)
+        fprintf(stderr, "spsc_stress: %s\n", msg);
+}
+
+static void isr(int sig){
+    uint8_t b;
+    unsigned int i;
+    (void)sig;
+    isr_calls++;
+    if(SPSC_AVAIL_READ(&sb) > SIZE)
+        fail("fill level exceeds size (isr)");
+    for(i = 0; i < 3; ++i){             // A few bytes per "interrupt"
+        if(rx_test){
+            if(!spsc_write(&sb, isr_seq))
+                break;
+            isr_seq++;
+        }else{
+            if(!spsc_read(&sb, &b))
+                break;
+            if(b != isr_seq)
+                fail("TX data out of order");
+            isr_seq++;
+        }
+        isr_bytes++;
+    }
+}
+
+static void start_timer(void){
+    struct itimerval it = {{0, TIMER_US}, {0, TIMER_US}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void stop_timer(void){
+    struct itimerval it = {{0, 0}, {0, 0}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void run(int rx, double seconds){
+    uint8_t buf[SIZE], seq = 0;
+    spsc_span spans[2];
+    unsigned long loops = 0;
+    unsigned int i, j, n;
+    time_t end = time(NULL) + (time_t)seconds;
+
+    spsc_init(&sb, array, SIZE);
+    rx_test = rx;
+    isr_seq = 0;
+    isr_bytes = 0;
+    isr_calls = 0;
+    start_timer();
+    while(time(NULL) < end){
+        if(SPSC_AVAIL_READ(&sb) > SIZE)
+            fail("fill level exceeds size (main)");
+        if(rx){
+            // Alternate block and span reads
+            if(loops & 1){
+                n = spsc_read_block(&sb, buf, (loops >> 1) % SIZE + 1);
+            }else{
+                n = 0;
+                spsc_peek_read(&sb, spans);
+                for(i = 0; i < 2; ++i)
+                    for(j = 0; j < spans[i].len; ++j)
+                        buf[n++] = spans[i].data[j];
+                spsc_commit_read(&sb, n);
+            }
+            for(i = 0; i < n; ++i, ++seq)
+                if(buf[i] != seq)
+                    fail("RX data out of order");
+        }else{
+            // Alternate block and span writes
+            if(loops & 1){
+                n = (loops >> 1) % SIZE + 1;
+                for(i = 0; i < n; ++i)
+                    buf[i] = seq + i;
+                seq += spsc_write_block(&sb, buf, n);
+            }else{
+                n = 0;
+                spsc_peek_write(&sb, spans);
+                for(i = 0; i < 2; ++i)
+                    for(j = 0; j < spans[i].len; ++j)
+                        spans[i].data[j] = seq + n++;
+                spsc_commit_write(&sb, n);
+                seq += n;
+            }
+        }
+        loops++;
+    }
+    stop_timer();
+    printf("%s: %lu interrupts, %lu bytes through isr, %lu main loops\n",
+            rx ? "RX" : "TX", (unsigned long)isr_calls,
+            (unsigned long)isr_bytes, loops);
+}
+
+int main(int argc, char **argv){
+    double seconds = 5;
+    struct sigaction sa;
+
+    if(argc > 1)
+        seconds = atof(argv[1]);
+    sa.sa_handler = isr;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+
+    run(0, seconds / 2);
+    run(1, seconds / 2);
+
+    if(errors){
+        printf("FAIL: %lu errors\n", (unsigned long)errors);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file stats_test.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Check the windowed statistics (src/stats.c) against double precision
+ * results. Each case fills one 60s window (samples 100ms apart) and closes
+ * it with one more sample. Mean must be within 0.5 and standard deviation
+ * within 1 (units of the samples).
+ *
+ * Build (Linux): cc -O2 -I../include -o stats_test stats_test.c ../src/stats.c -lm
+ * Usage: stats_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <stats.h>
+
+#define SAMPLES             600             // One window at 100ms
+
+static int failed;
+
+
+static int16_t ramp(unsigned int i){ return 2000 + i / 12; }
+static int16_t step(unsigned int i){ return i < 120 ? 2000 : 2003; }
+static int16_t slow(unsigned int i){ return 2000 + i / 300; }
+static int16_t noise(unsigned int i){ (void)i; return 2500 + rand() % 41 - 20; }
+static int16_t wide(unsigned int i){ (void)i; return rand() % 65536 - 32768; }
+static int16_t extremes(unsigned int i){ return (i & 1) ? 32767 : -32768; }
+static int16_t negative(unsigned int i){ return -4000 - (int)(i % 7); }
+static int16_t constant(unsigned int i){ (void)i; return 1234; }
+
+static void check_channel(const char *name, const char *ch, const stats_result *res,
+        const int16_t *x, unsigned int n){
+    double sum = 0, sq = 0, mean, sd;
+    int16_t min = x[0], max = x[0];
+    unsigned int i;
+
+    for(i = 0; i < n; ++i){
+        sum += x[i];
+        if(x[i] < min)
+            min = x[i];
+        if(x[i] > max)
+            max = x[i];
+    }
+    mean = sum / n;
+    for(i = 0; i < n; ++i)
+        sq += (x[i] - mean) * (x[i] - mean);
+    sd = sqrt(sq / (n - 1));
+
+    printf("%-9s %s  mean %9.2f (%6d)  sd %9.2f (%5u)  min %6d  max %6d\n",
+            name, ch, mean, res->mean, sd, res->sd, res->min, res->max);
+    if(fabs(res->mean - mean) > 0.5 || fabs(res->sd - sd) > 1 ||
+            res->min != min || res->max != max){
+        printf("  FAILED\n");
+        failed = 1;
+    }
+}
+
+static void check(const char *name, int16_t (*gen)(unsigned int)){
+    static int16_t t[SAMPLES], h[SAMPLES];
+    unsigned int i;
+
+    stats_init();
+    for(i = 0; i < SAMPLES; ++i){
+        t[i] = gen(i);
+        h[i] = (uint16_t)(t[i] + 10000) % 10001;    // Humidity-like (0 to 100.00)
+        if(stats_add(100000 + i * 100, t[i], (uint16_t)h[i])){
+            printf("%s: window closed early\n", name);
+            failed = 1;
+        }
+    }
+    if(!stats_add(100000 + SAMPLES * 100, 0, 0) || stats_last.count != SAMPLES){
+        printf("%s: window not closed (count %u)\n", name, stats_last.count);
+        failed = 1;
+        return;
+    }
+    check_channel(name, "T", &stats_last.temperature, t, SAMPLES);
+    check_channel(name, "H", &stats_last.humidity, h, SAMPLES);
+}
+
+int main(void){
+    srand(1);
+    check("ramp", ramp);
+    check("step", step);
+    check("slow", slow);
+    check("noise", noise);
+    check("wide", wide);
+    check("extremes", extremes);
+    check("negative", negative);
+    check("constant", constant);
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file time_sync.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Keep a board's clock synchronized to host time (see include/timesync.h).
+ * Sends the 'Y' command with the host time (ms since 1970, plus the time the
+ * command takes on the line) every period and reports each reply on stderr:
+ *   sync,rtt_ms,receipt_ms,error_ms,drift_ppm,offset_ms
+ * rtt is from sending the command to the end of the reply, receipt the
+ * board's timers_now when it handled the command, error how far the board's
+ * time was from the host time sent (0 on the first sync) and drift the clock
+ * correction the board now applies. offset is host time at the middle of the
+ * round trip minus receipt, the usual estimate of boot time.
+ *
+ * Everything read from the board (including the replies) is copied to stdout
+ * so samples can be piped to another tool at the same time, e.g.
+ *   time_sync /dev/ttyUSB0 | ingest
+ * Text replies are "Y:" lines; in binary mode they are FRAME_SYNC frames.
+ *
+ * Build (Linux): cc -O2 -I../include -o time_sync time_sync.c hostframe.c
+ * Usage: time_sync device [period_s] [count] [baud]
+ *                                      (default 60s, forever, 9600)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <frame.h>
+#include "hostframe.h"
+
+#define SYNC_BYTES              9           // 'Y' and 8 bytes of host time
+#define MAX_RECORD              256
+
+
+static int fd;
+static int binary;                          // Stream switched to frames
+static uint8_t rec[MAX_RECORD];             // Line or frame being collected
+static size_t rec_len;
+static int64_t sent_ms;                     // Host time last sync was sent
+static int waiting;                         // Reply not received yet
+static unsigned int syncs;
+
+
+static int64_t now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void report(uint32_t receipt, int32_t error, int32_t drift){
+    int64_t now = now_ms();
+    if(!waiting)
+        return;                             // Not ours (or late)
+    waiting = 0;
+    fprintf(stderr, "%u,%lld,%lu,%ld,%ld,%lld\n", ++syncs, (long long)(now - sent_ms),
+            (unsigned long)receipt, (long)error, (long)drift,
+            (long long)((sent_ms + now) / 2 - receipt));
+}
+
+static void text_line(void){
+    unsigned long receipt;
+    long error, drift;
+    rec[rec_len] = '\0';
+    if(sscanf((char*)rec, "Y: %lu %ld %ld", &receipt, &error, &drift) == 3)
+        report(receipt, error, drift);
+}
+
+static void frame(void){
+    long n = hostframe_decode(rec, rec_len);
+    long header;
+
+    if(n < 1)
+        return;
+    header = (rec[0] & FRAME_EPOCH) ? FRAME_EPOCH_SIZE : FRAME_HEADER_SIZE;
+    if(n != header + 12 || (rec[0] & ~FRAME_EPOCH) != FRAME_SYNC)
+        return;
+    report(hostframe_get32(&rec[header]), hostframe_get32(&rec[header + 4]),
+            hostframe_get32(&rec[header + 8]));
+}
+
+// Look for sync replies in data read from the board
+static void scan(const uint8_t *data, size_t len){
+    size_t i;
+    uint8_t b;
+    for(i = 0; i < len; ++i){
+        b = data[i];
+        if(b == 0){
+            if(binary && rec_len > 0)
+                frame();
+            binary = 1;                     // 'B' command sends a zero byte
+            rec_len = 0;
+        }else if(!binary && b == '\n'){
+            text_line();
+            rec_len = 0;
+        }else if(rec_len < MAX_RECORD - 1 && b != '\r'){
+            rec[rec_len++] = b;
+        }
+    }
+}
+
+static void send_sync(long baud){
+    uint8_t cmd[SYNC_BYTES];
+    uint64_t host;
+    int i;
+
+    // Board adopts the time when the command has arrived
+    sent_ms = now_ms();
+    host = sent_ms + SYNC_BYTES * 10 * 1000 / baud;
+    cmd[0] = 'Y';
+    for(i = 0; i < 8; ++i)
+        cmd[1 + i] = host >> (8 * i);
+    if(write(fd, cmd, sizeof(cmd)) != sizeof(cmd))
+        perror("time_sync: write");
+    waiting = 1;
+}
+
+int main(int argc, char **argv){
+    struct termios t;
+    struct pollfd pfd;
+    uint8_t buf[4096];
+    double period;
+    unsigned long count, sent = 0;
+    long baud;
+    int64_t next;
+    speed_t speed;
+    ssize_t n;
+
+    if(argc < 2){
+        fprintf(stderr, "Usage: time_sync device [period_s] [count] [baud]\n");
+        return 1;
+    }
+    period = argc > 2 ? atof(argv[2]) : 60;
+    count = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+    baud = argc > 4 ? atol(argv[4]) : 9600;
+    speed = baud == 115200 ? B115200 : baud == 57600 ? B57600 :
+            baud == 38400 ? B38400 : baud == 19200 ? B19200 : B9600;
+
+    fd = open(argv[1], O_RDWR | O_NOCTTY);
+    if(fd < 0){
+        perror(argv[1]);
+        return 1;
+    }
+    if(isatty(fd) && tcgetattr(fd, &t) == 0){
+        cfmakeraw(&t);
+        cfsetispeed(&t, speed);
+        cfsetospeed(&t, speed);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    fprintf(stderr, "sync,rtt_ms,receipt_ms,error_ms,drift_ppm,offset_ms\n");
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    next = now_ms();
+    for(;;){
+        if(now_ms() >= next){
+            if(count != 0 && sent == count)
+                break;
+            send_sync(baud);
+            sent++;
+            next += (int64_t)(period * 1000);
+        }
+        if(poll(&pfd, 1, next - now_ms() > 0 ? next - now_ms() : 0) < 0)
+            break;
+        if(pfd.revents & POLLIN){
+            n = read(fd, buf, sizeof(buf));
+            if(n <= 0)
+                break;
+            scan(buf, n);
+            fwrite(buf, 1, n, stdout);
+            fflush(stdout);
+        }else if(pfd.revents & (POLLHUP | POLLERR)){
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file timesync_sim.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Simulate host time synchronization (src/timesync.c) against a device clock
+ * with a rate error. timers_now advances 10ms per tick of the drifting clock.
+ * The host sends its time every sync period, adding the time the 9 byte 'Y'
+ * command takes on the line; delivery then varies by up to the given jitter
+ * (USB, host scheduling) and the device handles the command on its next
+ * tick. The difference between timesync_time and true host time is sampled
+ * every device second, after the drift estimate has had two sync periods
+ * (at least TIMESYNC_INTERVAL_MIN) to settle. Also checks fmt_uint64_str and a
+ * timers_now rollover.
+ *
+ * Build (Linux): cc -O2 -I../include -o timesync_sim timesync_sim.c ../src/timesync.c ../src/fmt.c
+ * Usage: timesync_sim [hours] [jitter_ms] [baud]    (default 6, 4, 9600)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <timesync.h>
+#include <fmt.h>
+
+#define HOST_EPOCH          1700000000000ULL    // Host ms since 1970 at start
+
+typedef struct {
+    double max_error, sum_error;
+    unsigned long n;
+    int32_t drift;
+} result;
+
+static result simulate(double ppm, double period_s, double hours, double jitter_ms,
+        double line_ms, uint32_t boot_now){
+    double tick = 10.0 / (1.0 + ppm / 1e6);    // Real ms per timers_now tick
+    double end = hours * 3600e3, real = 0, next_sync = period_s * 1e3, receipt = -1;
+    double settle = 2 * (period_s * 1e3 > 60e3 ? period_s * 1e3 : 60e3) + period_s * 1e3;
+    uint64_t sent = 0;
+    uint32_t now = boot_now;
+    unsigned long ticks = 0;
+    result r;
+    double e;
+
+    memset(&r, 0, sizeof(r));
+    timesync_init();
+    while(real < end){
+        ticks++;
+        real = ticks * tick;
+        now += 10;
+        if(receipt < 0 && real >= next_sync){
+            // Host sends its time plus the line time of the command
+            sent = HOST_EPOCH + (uint64_t)(next_sync + line_ms);
+            receipt = next_sync + line_ms + jitter_ms * rand() / RAND_MAX;
+            next_sync += period_s * 1e3;
+        }
+        if(receipt >= 0 && real >= receipt){
+            timesync_set(sent, now);
+            receipt = -1;
+        }
+        if(ticks % 100 == 0){
+            timesync_update(now);
+            if(real > settle){
+                e = (double)(int64_t)(timesync_time(now) - HOST_EPOCH) - real;
+                if(e < 0)
+                    e = -e;
+                if(e > r.max_error)
+                    r.max_error = e;
+                r.sum_error += e;
+                r.n++;
+            }
+        }
+    }
+    r.drift = timesync_drift;
+    return r;
+}
+
+static int check_str(void){
+    char buf[FMT_UINT64_MAX_LEN + 1], ref[32];
+    uint64_t v;
+    int i, fails = 0;
+
+    for(i = 0; i < 1000000; ++i){
+        v = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ rand();
+        if(i < 64)
+            v = i == 0 ? 0 : i == 1 ? UINT64_MAX : 1ULL << (i - 1);
+        v >>= i % 64;
+        fmt_uint64_str(v, buf);
+        snprintf(ref, sizeof(ref), "%" PRIu64, v);
+        if(strcmp(buf, ref) != 0 && fails++ < 5)
+            printf("fmt_uint64_str(%s) = %s\n", ref, buf);
+    }
+    return fails;
+}
+
+int main(int argc, char **argv){
+    static const double ppms[] = { 0, 500, 5000, 20000 };
+    static const double periods[] = { 10, 60, 600 };
+    double hours = argc > 1 ? atof(argv[1]) : 6;
+    double jitter = argc > 2 ? atof(argv[2]) : 4;
+    double baud = argc > 3 ? atof(argv[3]) : 9600;
+    double line_ms = 9 * 10 * 1e3 / baud;
+    unsigned int i, j;
+    result r;
+
+    if(check_str() != 0){
+        printf("fmt_uint64_str: FAILED\n");
+        return 1;
+    }
+    printf("fmt_uint64_str: PASSED\n");
+
+    // Boot time just before timers_now rolls over
+    r = simulate(5000, 60, 1, jitter, line_ms, 0xFFFFFFFFUL - 600000);
+    printf("rollover: max error %.1fms, drift %" PRId32 "ppm\n", r.max_error, r.drift);
+
+    printf("%.0fh, jitter 0-%.0fms, %.0f baud\n", hours, jitter, baud);
+    printf("clock ppm  sync s  max err ms  mean err ms  drift est ppm  uncorrected ms\n");
+    for(i = 0; i < sizeof(ppms) / sizeof(ppms[0]); ++i){
+        for(j = 0; j < sizeof(periods) / sizeof(periods[0]); ++j){
+            r = simulate(ppms[i], periods[j], hours, jitter, line_ms, 0);
+            printf("%9.0f  %6.0f  %10.1f  %11.1f  %13" PRId32 "  %14.1f\n", ppms[i],
+                    periods[j], r.max_error, r.sum_error / r.n, r.drift,
+                    ppms[i] * periods[j] / 1e3);
+        }
+    }
+    return 0;
+}
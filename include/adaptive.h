@@ -0,0 +1,84 @@
+/**
+ * @file adaptive.h
+ * @brief Adaptive sample rate driven by rate of change
+ *
+ * Sample interval is a multiple of the 100ms timer tick. When temperature or
+ * humidity changes faster than a threshold the interval drops to the fastest
+ * rate. While values are flat the interval grows back toward the slow floor.
+ * Rate of change is measured over at least ADAPTIVE_BASE_MS so sensor noise
+ * at fast rates does not look like change.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define ADAPTIVE_FAST           1           // Fastest interval (100ms ticks)
+#define ADAPTIVE_SLOW           50          // Slowest interval (100ms ticks)
+#define ADAPTIVE_BASE_MS        1000        // Min time to measure rate over
+#define ADAPTIVE_TEMP_RATE      5           // 0.05 deg C / sec
+#define ADAPTIVE_HUM_RATE       20          // 0.20 % / sec
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern bool adaptive_enabled;               // Adaptive sampling in use
+extern unsigned int adaptive_interval;      // Current interval (100ms ticks)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize (disabled; interval starts at slowest)
+ */
+void adaptive_init(void);
+
+/**
+ * Call every 100ms
+ * @return true if a sample should be taken now else false
+ */
+bool adaptive_tick(void);
+
+/**
+ * Update sample interval using a completed sample
+ * @param timestamp Time the sample completed (see timers_now)
+ * @param temperature Temperature
+ * @param humidity Humidity
+ */
+void adaptive_update(uint32_t timestamp, int16_t temperature, unsigned int humidity);
@@ -46,6 +46,8 @@
 #define AHT10_EC_NODEV              1       // Device not connected (I2C fail)
 #define AHT10_EC_NOCAL              2       // Device calibration failed
 
+#define AHT10_ADDR                  0x38    // I2C address (see bbi2c_trans)
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Globals
@@ -53,15 +55,14 @@
 
 // Last read temperature (deg C)
 // Last two digits are after decimal point
-extern unsigned int aht10_temperature;
+extern int16_t aht10_temperature;
 
 
 // Last read humidity (%)
 // Last two digits are after decimal point
 extern unsigned int aht10_humidity;
 
-extern unsigned int aht10_ec;               // Current error code for AHT10
-extern bbi2c_transaction aht10_trans;       // Transaction var for AHT10
+extern uint8_t aht10_ec;                    // Current error code for AHT10
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,81 @@
+/**
+ * @file alarm.h
+ * @brief High / low threshold alarms for temperature and humidity
+ *
+ * An alarm is raised when a value goes beyond its threshold and cleared once
+ * the value comes back inside the threshold by more than the hysteresis.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Alarm bits
+#define ALARM_TEMP_HIGH         0x01
+#define ALARM_TEMP_LOW          0x02
+#define ALARM_HUM_HIGH          0x04
+#define ALARM_HUM_LOW           0x08
+
+// Thresholds (same units as samples; build settings so they cost no RAM)
+#define ALARM_DEF_TEMP_HIGH     3500        // 35.00 deg C
+#define ALARM_DEF_TEMP_LOW      500         // 5.00 deg C
+#define ALARM_DEF_HUM_HIGH      8000        // 80.00 %
+#define ALARM_DEF_HUM_LOW       1000        // 10.00 %
+#define ALARM_DEF_TEMP_HYST     50          // 0.50 deg C
+#define ALARM_DEF_HUM_HYST      200         // 2.00 %
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern uint8_t alarm_state;                 // Currently active alarm bits
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize with no alarms active
+ */
+void alarm_init(void);
+
+/**
+ * Evaluate alarms for a sample
+ * @param temperature Temperature
+ * @param humidity Humidity
+ * @return Alarm bits that changed (raised or cleared; see alarm_state)
+ */
+unsigned int alarm_check(int16_t temperature, unsigned int humidity);
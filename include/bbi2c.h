@@ -51,7 +51,7 @@
 
 typedef struct {
     uint8_t address;
-    uint8_t *write_buf;
+    const uint8_t *write_buf;
     unsigned int write_count;
     uint8_t *read_buf;
     unsigned int read_count;
@@ -61,7 +61,7 @@ typedef struct {
 /// Globals
 ////////////////////////////////////////////////////////////////////////////////
 
-bbi2c_transaction *bbi2c_trans;
+extern const bbi2c_transaction *bbi2c_trans;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -79,6 +79,6 @@ bbi2c_transaction *bbi2c_trans;
 
 void bbi2c_init(void);
 
-void bbi2c_perform(bbi2c_transaction *trans);
+void bbi2c_perform(const bbi2c_transaction *trans);
 
 unsigned int bbi2c_next(void);
@@ -1,8 +1,11 @@
 /**
- * @file circular_buffer.h
- * @brief Ciruclar (ring) buffer implementation for comm protocols
- * Implemented to be ISR safe (uses volatile)
- * Read and write functions are inlinable
+ * @file calib.h
+ * @brief Per sensor calibration (offset and gain per channel)
+ *
+ * corrected = value + value * gain + offset
+ * gain is Q15 (-1.0 to 1.0; so total gain is 0.0 to 2.0) and is applied using
+ * shifts and adds only. Calibration is stored in info flash segment D with a
+ * checksum. Defaults (no correction) are used if it is missing or corrupt.
  * @author Marcus Behel (mgbehel@ncsu.edu)
  * @version 1.0.0
  */
@@ -34,36 +37,36 @@
 #pragma once
 
 #include <stdint.h>
-#include <stdbool.h>
+
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Typedefs
+/// Macros
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef struct {
-    volatile uint8_t *array;    // Array backing the buffer
-    unsigned int size;          // Size of backing array
-    unsigned int count;         // Number of bytes in buffer
-    unsigned int write_pos;     // Position to write data at
-    unsigned int read_pos;      // Position to read data from
-} circular_buffer;
+#define CALIB_ADDR              0x1000      // Info flash segment D
+#define CALIB_MAGIC             0xCA1B      // Marks valid calibration
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Macros
+/// Typedefs
 ////////////////////////////////////////////////////////////////////////////////
 
-// Check if buffer is full
-#define CB_FULL(cb)         ((cb)->count == (cb)->size)
+typedef struct {
+    int16_t offset;                         // Same units as value
+    int16_t gain;                           // Added gain (Q15)
+} calib_channel;
+
+typedef struct {
+    calib_channel temperature;
+    calib_channel humidity;
+} calib_data;
 
-// Check if buffer is empty
-#define CB_EMPTY(cb)        ((cb)->count == 0)
 
-// Number of bytes that can be written until buffer is full
-#define CB_AVAIL_WRITE(cb)  ((cb)->size - (cb)->count)
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
 
-// Number of bytes that can be read until buffer is empty
-#define CB_AVAIL_READ(cb)   ((cb)->count)
+extern const calib_data *calib;             // Calibration in use (flash)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -71,27 +74,21 @@ typedef struct {
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * Initialize a circular buffer with the given backing array
- * @param cb Circular buffer to initialize
- * @param backing_array Array to back the buffer
- * @param len Length of array backing the buffer
+ * Load calibration from info flash (or defaults)
+ * Must be called after flash_init.
  */
-void cb_init(volatile circular_buffer *cb, volatile uint8_t *backing_array, unsigned int len);
+void calib_init(void);
 
 /**
- * Write a byte into the buffer
- * @param cb Buffer to write into
- * @param src Byte to write
- * @return true If successfully written
- * @return false If buffer is full
+ * Use and store new calibration
+ * @param data New calibration
  */
-bool cb_write(volatile circular_buffer *cb, uint8_t src);
+void calib_store(const calib_data *data);
 
 /**
- * Read a byte from the bufffer
- * @param cb Circular buffer to read from
- * @param dest Pointer to destination to move read byte into
- * @return true If successfully read
- * @return false If buffer is empty
+ * Apply calibration to a value
+ * @param ch Channel calibration
+ * @param value Value to correct
+ * @return Corrected value (saturated to the int16 range)
  */
-bool cb_read(volatile circular_buffer *cb, uint8_t *dest);
+int16_t calib_apply(const calib_channel *ch, int16_t value);
@@ -0,0 +1,82 @@
+/**
+ * @file change.h
+ * @brief Report on change. Decides when a sample is worth transmitting.
+ *
+ * A sample is reported when temperature or humidity has moved more than a
+ * deadband away from the last reported value, or when nothing has been
+ * reported for the heartbeat period.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define CHANGE_DEF_TEMP_BAND    10          // 0.10 deg C
+#define CHANGE_DEF_HUM_BAND     50          // 0.50 %
+#define CHANGE_DEF_HEARTBEAT    60          // 60 sec
+#define CHANGE_MAX_BAND         10000       // Largest deadband (100.00)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern unsigned int change_temp_band;       // Deadband (same units as samples)
+extern unsigned int change_hum_band;        // Deadband (same units as samples)
+extern unsigned int change_heartbeat;       // Max time between reports (sec)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize with default deadbands and heartbeat. Next sample is reported.
+ */
+void change_init(void);
+
+/**
+ * Report the next sample regardless of deadbands (deadbands are kept)
+ */
+void change_reset(void);
+
+/**
+ * Check if a sample should be reported. If so it becomes the last reported.
+ * @param timestamp Time the sample completed (see timers_now)
+ * @param temperature Temperature
+ * @param humidity Humidity
+ * @return true if sample should be reported else false
+ */
+bool change_check(uint32_t timestamp, int16_t temperature, unsigned int humidity);
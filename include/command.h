@@ -0,0 +1,122 @@
+/**
+ * @file command.h
+ * @brief Incremental parser for commands received on uca0uart
+ * Bytes are consumed from the uca0uart read buffer one at a time with bounded
+ * work per byte so parsing never holds up the main loop. Two forms:
+ * - Single byte commands (e.g. 'D'). Some take binary argument bytes ('K').
+ * - Text lines starting with '$' and ending with CR or LF (e.g. "$RATE 2000").
+ *   Names are not case sensitive.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define COMMAND_START       '$'         // First char of a line command
+#define COMMAND_LINE_MAX    12          // Max chars after '$' (not CR / LF)
+#define COMMAND_ARGS_MAX    8           // Max argument bytes (single byte cmd)
+
+// Single byte commands. The byte is the command id.
+#define COMMAND_CALIB_SET   'K'         // Set calibration (8 argument bytes)
+#define COMMAND_CALIB_GET   'k'         // Print calibration
+#define COMMAND_SYNC        'Y'         // Set host time (8 argument bytes)
+#define COMMAND_HISTORY     'D'         // Dump sample history
+#define COMMAND_FLASHLOG    'F'         // Dump sample log from flash
+#define COMMAND_BINARY      'B'         // Binary frame output
+#define COMMAND_TEXT        'T'         // Text output
+#define COMMAND_DERIVED     'M'         // Toggle derived metrics output
+#define COMMAND_PERIODIC    'P'         // Print every sample
+#define COMMAND_SUMMARY     'W'         // Print window statistics only
+#define COMMAND_CHANGE      'C'         // Print samples when changed
+#define COMMAND_ADAPTIVE    'V'         // Toggle adaptive sampling
+#define COMMAND_QUERY       '?'         // Print last conversion
+#define COMMAND_QUERY_FRESH '!'         // Print next conversion
+#define COMMAND_RATE_REPORT 'R'         // Print samples/hour and CPU use
+#define COMMAND_UART_REPORT 'U'         // Print UART drops and buffer use
+#define COMMAND_FILTER_NONE 'N'         // No filter
+#define COMMAND_FILTER_MA   'A'         // Moving average filter
+#define COMMAND_FILTER_EMA  'E'         // Exponential moving average filter
+#define COMMAND_FILTER_MED3 '3'         // 3 tap median filter
+#define COMMAND_FILTER_MED5 '5'         // 5 tap median filter
+
+// Ids of line commands. Bytes from 0x80 are ignored as single byte commands
+// so they never alias these.
+#define COMMAND_RATE        0x80        // "$RATE ms": Set sample interval
+#define COMMAND_READ        0x81        // "$READ": Read sensor now
+#define COMMAND_DUMP        0x82        // "$DUMP": Dump sample history
+#define COMMAND_STATS       0x83        // "$STATS": Print last window stats
+#define COMMAND_FORMAT      0x84        // "$FMT BIN|TEXT": Output format
+#define COMMAND_NODE        0x85        // "$NODE id": RS-485 polled mode
+#define COMMAND_TBAND       0x86        // "$TBAND n": Temperature deadband
+#define COMMAND_HBAND       0x87        // "$HBAND n": Humidity deadband
+#define COMMAND_INVALID     0xFF        // Line not understood (or too long)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint8_t id;                         // Command byte or COMMAND_* id
+    int32_t arg;                        // Number argument (e.g. COMMAND_RATE) or
+                                        // 1 for binary, 0 text (COMMAND_FORMAT)
+    uint8_t args[COMMAND_ARGS_MAX];     // Argument bytes ('K', 'Y')
+} command;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize parser (discards any partial command)
+ */
+void command_init(void);
+
+/**
+ * Parse one received byte
+ * @param b Received byte
+ * @param cmd Filled in when a command is complete
+ * @return true if b completed a command else false
+ */
+bool command_feed(uint8_t b, command *cmd);
+
+/**
+ * Consume bytes from the uca0uart read buffer until one command is complete
+ * or no bytes remain. Bytes after a complete command are left in the buffer.
+ * @param cmd Filled in when a command is complete
+ * @return true if a command was completed else false
+ */
+bool command_next(command *cmd);
@@ -0,0 +1,72 @@
+/**
+ * @file derived.h
+ * @brief Metrics derived from temperature and humidity
+ *
+ * Integer only. Logarithm and exponential terms use small lookup tables
+ * (in flash) with linear interpolation.
+ *
+ * Dew point uses the Magnus formula (b = 17.62, c = 243.12 deg C).
+ * Absolute humidity uses the Magnus saturation vapor pressure.
+ * Heat index uses the Rothfusz regression (Celsius coefficients). Below
+ * 26.7 deg C heat index is the temperature. Above 50 deg C it is clamped.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Dew point
+ * @param temperature Temperature (deg C; last two digits after decimal point)
+ * @param humidity Relative humidity (%; last two digits after decimal point)
+ * @return Dew point (deg C; last two digits after decimal point)
+ */
+int16_t derived_dew_point(int16_t temperature, unsigned int humidity);
+
+/**
+ * Absolute humidity
+ * @param temperature Temperature (deg C; last two digits after decimal point)
+ * @param humidity Relative humidity (%; last two digits after decimal point)
+ * @return Absolute humidity (g/m^3; last two digits after decimal point).
+ *         Saturates at 655.35 (above about 100 deg C).
+ */
+unsigned int derived_abs_humidity(int16_t temperature, unsigned int humidity);
+
+/**
+ * Heat index (apparent temperature)
+ * @param temperature Temperature (deg C; last two digits after decimal point)
+ * @param humidity Relative humidity (%; last two digits after decimal point)
+ * @return Heat index (deg C; last two digits after decimal point)
+ */
+int16_t derived_heat_index(int16_t temperature, unsigned int humidity);
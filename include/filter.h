@@ -0,0 +1,103 @@
+/**
+ * @file filter.h
+ * @brief Integer filter and decimator between the AHT10 driver and outputs
+ *
+ * When a filter is selected the sensor is sampled FILTER_DECIMATE times faster
+ * than samples are reported. Every sample goes through the filter and every
+ * FILTER_DECIMATE'th filtered value is reported. Without a filter every sample
+ * is reported unchanged. All state is statically allocated.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Filter types
+#define FILTER_NONE             0           // Report raw samples
+#define FILTER_MA               1           // Moving average of FILTER_TAPS
+#define FILTER_EMA              2           // Exponential moving average
+#define FILTER_MEDIAN3          3           // Median of last 3 samples
+#define FILTER_MEDIAN5          4           // Median of last 5 samples
+
+#define FILTER_TAPS             5           // History length (one report)
+#define FILTER_EMA_SHIFT        2           // EMA alpha = 1 / 2^shift
+#define FILTER_DECIMATE         5           // Samples per report (filtered)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+// Only one filter runs at a time (filter_set_type resets state)
+typedef union {
+    int16_t taps[FILTER_TAPS];              // Most recent samples (MA, median)
+    int32_t ema;                            // EMA state (Q4)
+} filter_channel;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern uint8_t filter_type;                 // Selected filter
+
+// Last reported values (same units as aht10_temperature / aht10_humidity)
+extern int16_t filter_temperature;
+extern unsigned int filter_humidity;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize filter (no filter selected)
+ */
+void filter_init(void);
+
+/**
+ * Select filter type. Resets filter state.
+ * @param type Filter type (FILTER_NONE, FILTER_MA, ...)
+ */
+void filter_set_type(unsigned int type);
+
+/**
+ * Add a sample to the filter
+ * @param temperature Temperature (see aht10_temperature)
+ * @param humidity Humidity (see aht10_humidity)
+ * @return true if a value should be reported (see filter_temperature and
+ *         filter_humidity) else false
+ */
+bool filter_add(int16_t temperature, unsigned int humidity);
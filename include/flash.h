@@ -0,0 +1,71 @@
+/**
+ * @file flash.h
+ * @brief Flash controller (erase and word writes of main / info flash)
+ *
+ * Flash is only written by the functions here. CPU is held (and interrupts are
+ * disabled) while the flash controller is busy. A segment erase takes about
+ * 12ms and a word write about 75us.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define FLASH_MAIN_SEGMENT_SIZE     512     // Bytes per main flash segment
+#define FLASH_INFO_SEGMENT_SIZE     64      // Bytes per info flash segment
+#define FLASH_ERASED_WORD           0xFFFF  // Value of an erased word
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Configure flash controller timing generator
+ */
+void flash_init(void);
+
+/**
+ * Erase the segment containing the given address
+ * @param addr Any address in the segment to erase
+ */
+void flash_erase(const void *addr);
+
+/**
+ * Write words to flash. Destination must be erased (or only clear bits).
+ * @param dest Destination in flash (word aligned)
+ * @param src Words to write
+ * @param count Number of words to write
+ */
+void flash_write(const void *dest, const uint16_t *src, unsigned int count);
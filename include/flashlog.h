@@ -0,0 +1,106 @@
+/**
+ * @file flashlog.h
+ * @brief Append only sample log in main flash (survives reset)
+ *
+ * The log occupies FLASHLOG_SEGMENTS main flash segments starting at
+ * FLASHLOG_START (reserved in lnk_msp430g2553.cmd). Segments are used in
+ * rotation so each is erased equally often. The oldest segment is erased when
+ * the newest one is full.
+ *
+ * Segment layout (words):
+ *     sequence number (increments with each segment used)
+ *     records...
+ * Record layout (words):
+ *     header: FLASHLOG_MAGIC | number of samples
+ *     samples: timestamp low, timestamp high, temperature, humidity | status
+ *     commit: 0x0000 (written last; record is ignored if not committed)
+ *
+ * Only every FLASHLOG_DECIMATE'th sample is logged. Samples are written to
+ * flash as they arrive (no RAM copy) into a record of FLASHLOG_BATCH samples
+ * whose header is written when it is opened and whose commit is written once
+ * it is full. At the default settings a segment is erased roughly every
+ * 4 hours (about 4 years for 10k erase cycles). Up to FLASHLOG_BATCH logged
+ * samples (the open record) are lost on reset.
+ *
+ * Dump format (little endian):
+ *     'F', sample count (2 bytes), then samples of HISTORY_RECORD_BYTES bytes
+ *     each in the keyframe layout of history.h
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Must match FLASHLOG in lnk_msp430g2553.cmd
+#ifndef FLASHLOG_START
+#define FLASHLOG_START          0xC000
+#endif
+#define FLASHLOG_SEGMENTS       4
+
+#define FLASHLOG_BATCH          4           // Samples per record
+#define FLASHLOG_DECIMATE       120         // Log every Nth sample (1 min)
+#define FLASHLOG_MAGIC          0x5A00      // Record header (upper byte)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize flash log. Scans flash to find the end of the log.
+ * Must be called after flash_init.
+ */
+void flashlog_init(void);
+
+/**
+ * Offer a sample to the log. Only every FLASHLOG_DECIMATE'th sample is kept.
+ * @param timestamp Time the sample completed (see timers_now)
+ * @param temperature Temperature (see aht10_temperature)
+ * @param humidity Humidity (see aht10_humidity)
+ * @param status Status of the sensor (see aht10_ec)
+ */
+void flashlog_add(uint32_t timestamp, int16_t temperature, unsigned int humidity, unsigned int status);
+
+/**
+ * Start streaming every logged sample over uca0uart (see flashlog_dump_next)
+ * No effect if a dump is already in progress.
+ */
+void flashlog_dump_start(void);
+
+/**
+ * Continue a dump in progress. Call periodically from the main loop.
+ * @return true if a dump is still in progress else false
+ */
+bool flashlog_dump_next(void);
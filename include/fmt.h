@@ -0,0 +1,108 @@
+/**
+ * @file fmt.h
+ * @brief Signed fixed point formatting directly into buffer spans
+ * Values are integers with a number of digits after the decimal point (e.g.
+ * 2345 with 2 decimals is "23.45"). A sign is written only if negative.
+ * Unsigned 64-bit values (e.g. host time in ms) are written as plain digits.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <spsc_buffer.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Max length without padding (sign, 10 digits, point)
+#define FMT_MAX_LEN         12
+
+// Max length of an unsigned 64-bit value (digits)
+#define FMT_UINT64_MAX_LEN  20
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Length a value will have when formatted
+ * @param value Value to format
+ * @param decimals Digits after the decimal point (0 for no point)
+ * @param width Min length (padded with leading spaces)
+ * @return Number of chars (no null)
+ */
+unsigned int fmt_fixed_len(int32_t value, unsigned int decimals, unsigned int width);
+
+/**
+ * Format a value into (up to) two contiguous regions (e.g. from
+ * spsc_peek_write). Nothing is written if it does not fit.
+ * @param value Value to format
+ * @param decimals Digits after the decimal point (0 for no point)
+ * @param width Min length (padded with leading spaces)
+ * @param spans Regions to write into (spans[0] first)
+ * @return Number of chars written (no null). 0 if not enough space.
+ */
+unsigned int fmt_fixed(int32_t value, unsigned int decimals, unsigned int width, spsc_span spans[2]);
+
+/**
+ * Format a value into a null terminated string
+ * @param value Value to format
+ * @param decimals Digits after the decimal point (0 for no point)
+ * @param width Min length (padded with leading spaces)
+ * @param buf String to write into (at least FMT_MAX_LEN + 1 or width + 1)
+ * @return Length of string
+ */
+unsigned int fmt_fixed_str(int32_t value, unsigned int decimals, unsigned int width, char *buf);
+
+/**
+ * Length an unsigned 64-bit value will have when formatted
+ * @param value Value to format
+ * @return Number of digits
+ */
+unsigned int fmt_uint64_len(uint64_t value);
+
+/**
+ * Format an unsigned 64-bit value into (up to) two contiguous regions.
+ * Nothing is written if it does not fit.
+ * @param value Value to format
+ * @param spans Regions to write into (spans[0] first)
+ * @return Number of digits written. 0 if not enough space.
+ */
+unsigned int fmt_uint64(uint64_t value, spsc_span spans[2]);
+
+/**
+ * Format an unsigned 64-bit value into a null terminated string
+ * @param value Value to format
+ * @param buf String to write into (at least FMT_UINT64_MAX_LEN + 1 chars)
+ * @return Length of string
+ */
+unsigned int fmt_uint64_str(uint64_t value, char *buf);
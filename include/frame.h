@@ -0,0 +1,126 @@
+/**
+ * @file frame.h
+ * @brief Binary telemetry frames (COBS framed, CRC-16 checked)
+ *
+ * Frame (before COBS encoding, multi-byte fields little endian):
+ *   type (1) | seq (1) | timestamp ms (4) | payload (0-16) | CRC-16 (2)
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) covers type through payload.
+ * Once host time is known (see timesync.h) types have FRAME_EPOCH set and the
+ * timestamp is 8 bytes of host time (ms since 1970) instead of time since boot
+ * (except FRAME_ALARM, which must fit the uca0uart priority buffer).
+ * The encoded frame contains no zero bytes and is followed by a single 0x00
+ * delimiter. Decode with host/frame_decode.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <spsc_buffer.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Frame types
+#define FRAME_SAMPLE            0x01        // temp, hum [, dp, ah, hi]
+#define FRAME_SUMMARY           0x02        // temp min max mean sd, hum ...
+#define FRAME_ALARM             0x03        // state, changed, temp, hum
+#define FRAME_QUERY             0x04        // age (ms), temp, hum
+#define FRAME_SYNC              0x05        // receipt (timers_now), error, drift
+
+#define FRAME_EPOCH             0x40        // Type flag: 8 byte host timestamp
+
+#define FRAME_HEADER_SIZE       6           // type, seq, timestamp
+#define FRAME_EPOCH_SIZE        10          // Header with FRAME_EPOCH
+#define FRAME_CRC_SIZE          2
+#define FRAME_MAX_PAYLOAD       16
+
+// Max encoded size (COBS overhead for frames < 254 bytes is 1, plus delimiter)
+#define FRAME_MAX_SIZE          (FRAME_EPOCH_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE + 2)
+
+// Max encoded size of a frame with the given payload length (either header)
+#define FRAME_SIZE(len)         (FRAME_EPOCH_SIZE + (len) + FRAME_CRC_SIZE + 2)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+// Sequence number of the next frame (wraps)
+extern uint8_t frame_seq;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Store a 16-bit value (little endian)
+ * @param dest Where to store value (2 bytes)
+ * @param value Value to store
+ * @return dest + 2
+ */
+uint8_t *frame_put16(uint8_t *dest, uint16_t value);
+
+/**
+ * Update a CRC-16/CCITT-FALSE with more data
+ * @param crc CRC so far (0xFFFF to start)
+ * @param data Data to add
+ * @param len Number of bytes in data
+ * @return Updated CRC
+ */
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, unsigned int len);
+
+/**
+ * COBS encode in place and add the trailing delimiter
+ * Data to encode is at position 1 to len of (up to) two contiguous regions
+ * (position 0 is for the first code byte). Encoding never overtakes the data
+ * still to be read.
+ * @param buf Regions holding the data (at least len + 2 bytes in total; len
+ *            up to 253)
+ * @param len Number of bytes to encode
+ * @return Number of encoded bytes (len + 2, including delimiter)
+ */
+unsigned int frame_cobs(spsc_span buf[2], unsigned int len);
+
+/**
+ * Build a COBS encoded frame (including trailing delimiter) in (up to) two
+ * contiguous regions (e.g. from uca0uart_peek_write; no copy is needed)
+ * Uses and increments frame_seq.
+ * @param type Frame type (see FRAME_SAMPLE, etc; with FRAME_EPOCH for 8 byte
+ *             timestamp)
+ * @param timestamp Timestamp for the frame (see timesync_time)
+ * @param payload Payload bytes
+ * @param len Number of payload bytes (at most FRAME_MAX_PAYLOAD)
+ * @param dest Regions for encoded frame (at least FRAME_SIZE(len) bytes)
+ * @return Number of bytes written to dest
+ */
+unsigned int frame_encode(uint8_t type, uint64_t timestamp,
+        const uint8_t *payload, unsigned int len, spsc_span dest[2]);
@@ -0,0 +1,149 @@
+/**
+ * @file history.h
+ * @brief Compressed history of completed AHT10 samples
+ *
+ * Samples are delta encoded into a small number of fixed size blocks. Each
+ * block starts with a keyframe (full values) followed by encoded samples. When
+ * every block is full the oldest block is discarded to make room. The whole
+ * history can be streamed over uca0uart in one burst (see history_dump_start).
+ * A decoder for Linux is in host/history_decode.c
+ *
+ * Keyframe (HISTORY_KEYFRAME_BYTES bytes; little endian):
+ *     timestamp (4 bytes; ms since boot)
+ *     temperature (2 bytes; signed; deg C * 100)
+ *     humidity | (status << 14) (2 bytes; % * 100; status is aht10_ec)
+ *
+ * Encoded sample (deltas are from the previous sample in the block; dod is
+ * timestamp delta - previous timestamp delta; hum is humidity | (status << 14))
+ *     Tiny  (both deltas in -1 to 1):
+ *           varint(((zigzag(dod) * 9 + (temperature delta + 1) * 3
+ *                   + (hum delta + 1)) << 2) | 2)
+ *     Short (both deltas in -8 to 7):
+ *           varint((zigzag(dod) << 2) | 1),
+ *           one byte ((temperature delta + 8) << 4) | (hum delta + 8)
+ *     Long: varint(zigzag(dod) << 2),
+ *           varint(zigzag(temperature delta)), varint(zigzag(hum delta))
+ *
+ * Varints are 7 bits per byte, least significant group first, with BIT7 set
+ * on every byte except the last. A steady sample takes 1 byte where an
+ * uncompressed record takes HISTORY_RECORD_BYTES.
+ *
+ * Dump format (all multi-byte values little endian):
+ *     'H', sample count (1 byte), seq of first sample (4 bytes),
+ *     compression ratio * 100 (2 bytes), block count (1 byte),
+ *     then for each block (oldest first): length (1 byte), block bytes
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define HISTORY_BLOCKS          1       // Number of blocks
+#define HISTORY_BLOCK_SIZE      16      // Bytes per block (RAM!)
+#define HISTORY_KEYFRAME_BYTES  8       // Bytes in a keyframe
+#define HISTORY_RECORD_BYTES    8       // Bytes in an uncompressed record
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint8_t data[HISTORY_BLOCK_SIZE];   // Keyframe then encoded samples
+    uint8_t len;                        // Number of bytes of data used
+    uint8_t count;                      // Number of samples in block
+} history_block;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+// Total number of samples ever added. Sequence number of the next sample.
+extern uint32_t history_seq;
+
+// Samples dropped because they arrived during a dump and needed a new block
+extern unsigned int history_dump_lost;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize (empty) the history
+ */
+void history_init(void);
+
+/**
+ * Add a sample to the history. Discards the oldest block if full.
+ * Samples added while a dump is in progress are appended after the bytes
+ * being sent. One that needs a new block (discarding the oldest, which is
+ * being sent) is dropped and counted in history_dump_lost. A dump takes about
+ * 40ms at 9600 baud, so at most one sample (100ms report rate) arrives during
+ * it unless it waits behind other output.
+ * @param timestamp Time the sample completed (see timers_now)
+ * @param temperature Temperature (see aht10_temperature)
+ * @param humidity Humidity (see aht10_humidity)
+ * @param status Status of the sensor (see aht10_ec)
+ */
+void history_add(uint32_t timestamp, int16_t temperature, unsigned int humidity, unsigned int status);
+
+/**
+ * Number of samples currently held
+ * @return Number of samples
+ */
+unsigned int history_count(void);
+
+/**
+ * Achieved compression ratio (uncompressed size / encoded size)
+ * @return Compression ratio * 100 (0 if history is empty)
+ */
+unsigned int history_ratio(void);
+
+/**
+ * Start streaming every held sample over uca0uart. Blocks are sent directly
+ * from RAM (see uca0uart_write_segment) so they must not be discarded until
+ * they are sent (see history_add and history_dump_next).
+ * No effect if a dump is already in progress or uca0uart has no space (the
+ * host should ask again).
+ */
+void history_dump_start(void);
+
+/**
+ * Finish a dump once sent. Call periodically from the main loop.
+ * @return true if a dump is still in progress else false
+ */
+bool history_dump_next(void);
@@ -45,6 +45,24 @@
  */
 unsigned int int_to_str(int32_t value, char *data);
 
+/**
+ * Unsigned 16-bit integer to string representation. Same output as int_to_str
+ * (including the leading '+') but only uses 16-bit operations (see udiv10_16).
+ * @param value Value to convert to string
+ * @param data String to write into. MUST BE AT LEAST 7 CHARS WIDE
+ * @return Index of the null terminator in the string (string length)
+ */
+unsigned int uint16_to_str(uint16_t value, char *data);
+
+/**
+ * Signed 16-bit integer to string representation. Same output as int_to_str
+ * but only uses 16-bit operations (see udiv10_16).
+ * @param value Value to convert to string
+ * @param data String to write into. MUST BE AT LEAST 7 CHARS WIDE
+ * @return Index of the null terminator in the string (string length)
+ */
+unsigned int int16_to_str(int16_t value, char *data);
+
 /**
  * Unsigned divide by 10 using bitwise operations. Based on method from
  * http://web.archive.org/web/20180517023231/http://www.hackersdelight.org/divcMore.pdf
@@ -55,6 +73,15 @@ unsigned int int_to_str(int32_t value, char *data);
  */
 void udiv10(uint32_t n, uint32_t *q, uint32_t *r);
 
+/**
+ * Unsigned 16-bit divide by 10 using bitwise operations (same method as
+ * udiv10 with only 16-bit shifts; exact for all 16-bit values)
+ * @param n Number to divide by 10
+ * @param q Quotient
+ * @param r Remainder
+ */
+void udiv10_16(uint16_t n, uint16_t *q, uint16_t *r);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Macros
@@ -0,0 +1,122 @@
+/**
+ * @file node.h
+ * @brief Addressed request / response protocol for multi-drop RS-485 lines
+ * When a node ID is set the board only transmits in reply to requests for its
+ * ID. Requests and replies are COBS encoded (see frame_cobs) and end in a zero
+ * byte; the last two bytes before encoding are a CRC-16/CCITT-FALSE (little
+ * endian) of the rest.
+ *   Read request:  id, NODE_FN_READ, first register, count
+ *   Read reply:    id | NODE_REPLY, NODE_FN_READ, count, values (16-bit LE)
+ *   Write request: id, NODE_FN_WRITE, register, value (16-bit LE)
+ *   Write reply:   id | NODE_REPLY, NODE_FN_WRITE, register, value
+ *   Error reply:   id | NODE_REPLY, function | NODE_FN_ERROR, NODE_ERR_*
+ * Requests to NODE_BROADCAST are handled by all nodes and never answered.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define NODE_ADDR           0x1040      // Info flash segment C
+#define NODE_MAGIC          0x4E0D      // Marks valid node ID
+
+#define NODE_BROADCAST      0           // Request for all nodes (no reply)
+#define NODE_ID_MAX         127         // IDs 1 to 127. 0 means not polled.
+#define NODE_REPLY          0x80        // Set in ID byte of replies
+
+// Functions
+#define NODE_FN_READ        0x03        // Read registers
+#define NODE_FN_WRITE       0x06        // Write one register
+#define NODE_FN_ERROR       0x80        // Set in function byte of errors
+
+// Error codes
+#define NODE_ERR_FUNCTION   1           // Unknown function
+#define NODE_ERR_ADDRESS    2           // Register(s) do not exist / read only
+#define NODE_ERR_VALUE      3           // Value not allowed
+
+// Registers (16-bit). Latest conversion (calibrated, not filtered).
+#define NODE_REG_TEMP       0           // Temperature (deg C * 100)
+#define NODE_REG_HUM        1           // Humidity (% * 100)
+#define NODE_REG_AGE        2           // Age of conversion (ms, saturates)
+#define NODE_REG_STATUS     3           // AHT10 error code (AHT10_EC_*)
+#define NODE_REG_ALARM      4           // Active alarm bits (see alarm.h)
+#define NODE_REG_COUNT      5           // Conversions completed (wraps)
+#define NODE_REG_ID         6           // Node ID (write 0 to stop polling)
+#define NODE_REGS           7
+
+#define NODE_REQUEST_MAX    7           // Longest request (write), unencoded
+#define NODE_REPLY_MAX      (3 + 2 * NODE_REGS + 2) // Longest reply, unencoded
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern uint8_t node_id;                 // This node's ID (0 if not polled)
+extern uint32_t node_sample_time;       // timers_now of last conversion
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Load node ID from info flash (0 if none)
+ * Must be called after flash_init.
+ */
+void node_init(void);
+
+/**
+ * Set node ID and store it in info flash
+ * @param id Node ID (0 to stop polled mode)
+ */
+void node_store(uint8_t id);
+
+/**
+ * Record that a conversion completed (for NODE_REG_AGE and NODE_REG_COUNT)
+ */
+void node_sample(void);
+
+/**
+ * Parse one received byte. Replies (through uca0uart) when it completes a
+ * valid request for this node.
+ * @param b Received byte
+ */
+void node_feed(uint8_t b);
+
+/**
+ * Parse all bytes in the uca0uart read buffer
+ */
+void node_poll(void);
@@ -41,6 +41,7 @@
 #define GRN_LED                 BIT0
 #define UCA0RXD                 BIT1
 #define UCA0TXD                 BIT2
+#define RS485_TXEN              BIT4        // RS-485 driver enable (DE)
 #define RED_LED                 BIT6
 
 // Port 2
@@ -60,6 +61,10 @@
 #define RED_LED_OFF             P1OUT &= ~RED_LED
 #define RED_LED_TOGGLE          P1OUT ^= RED_LED
 
+// High while uca0uart is transmitting (low to receive on RS-485)
+#define RS485_TXEN_ON           P1OUT |= RS485_TXEN
+#define RS485_TXEN_OFF          P1OUT &= ~RS485_TXEN
+
 // PxOUT is configured so pin is low in output mode
 // In input mode, external (I2C) pullups take over making the line high
 // Changing pin direction changes high vs low
@@ -0,0 +1,144 @@
+/**
+ * @file ring.h
+ * @brief Typed single producer single consumer ring buffers (macro generated)
+ *
+ * Same rules as spsc_buffer: only the producer writes head and only the
+ * consumer writes tail, so one side may be an ISR. Records are written and
+ * read in place (reserve / commit, peek / release), so no copy is needed.
+ *
+ * In a header:     RING_DECLARE(sample_ring, sample, 4)
+ * In one .c file:  RING_DEFINE(sample_ring, sample, 4)
+ * Producer:        if((s = sample_ring_reserve(&r)) != NULL){
+ *                      s->temperature = ...; sample_ring_commit(&r); }
+ * Consumer:        if((s = sample_ring_peek(&r)) != NULL){
+ *                      use(s); sample_ring_release(&r); }
+ *
+ * RING_DEFINE should be in a different file than the code using the ring so
+ * commit and release are calls the compiler can not move record accesses
+ * across (also enforced with a barrier when compiled with GCC).
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Prevent the compiler moving memory accesses across this point
+#if defined(__GNUC__)
+#define RING_BARRIER()      __asm__ __volatile__("" ::: "memory")
+#else
+#define RING_BARRIER()
+#endif
+
+// Number of records in ring
+#define RING_COUNT(r)       ((unsigned int)((r)->head - (r)->tail))
+
+// Check if ring is empty
+#define RING_EMPTY(r)       ((r)->head == (r)->tail)
+
+// Check if ring is full
+#define RING_FULL(r)        (RING_COUNT(r) >= sizeof((r)->items) / sizeof((r)->items[0]))
+
+/**
+ * Declare a ring type (name) holding capacity records of type and its
+ * functions. Capacity must be a power of two (checked at compile time).
+ *   void name_init(name *r)                    Empty the ring
+ *   type *name_reserve(name *r)                Slot to fill or NULL if full
+ *   void name_commit(name *r)                  Publish reserved slot
+ *   bool name_push(name *r, const type *src)   Copy record in (false if full)
+ *   type *name_peek(name *r)                   Oldest record or NULL if empty
+ *   void name_release(name *r)                 Remove oldest record
+ *   bool name_pop(name *r, type *dest)         Copy record out (false if empty)
+ */
+#define RING_DECLARE(name, type, capacity)                                     \
+    typedef char name##_capacity_check[                                        \
+            ((capacity) != 0 && ((capacity) & ((capacity) - 1)) == 0) ? 1 : -1];\
+    typedef struct {                                                           \
+        volatile unsigned int head;     /* Records written (producer only) */  \
+        volatile unsigned int tail;     /* Records read (consumer only) */     \
+        type items[capacity];                                                  \
+    } name;                                                                    \
+    void name##_init(name *r);                                                 \
+    type *name##_reserve(name *r);                                             \
+    void name##_commit(name *r);                                               \
+    bool name##_push(name *r, const type *src);                                \
+    type *name##_peek(name *r);                                                \
+    void name##_release(name *r);                                              \
+    bool name##_pop(name *r, type *dest);
+
+/**
+ * Define functions for a ring declared with RING_DECLARE (same arguments)
+ */
+#define RING_DEFINE(name, type, capacity)                                      \
+    void name##_init(name *r){                                                 \
+        r->head = 0;                                                           \
+        r->tail = 0;                                                           \
+    }                                                                          \
+    type *name##_reserve(name *r){                                             \
+        unsigned int head = r->head;                                           \
+        if(head - r->tail >= (capacity))                                       \
+            return NULL;                                                       \
+        return &r->items[head & ((capacity) - 1)];                             \
+    }                                                                          \
+    void name##_commit(name *r){                                               \
+        RING_BARRIER();                 /* Record written before publish */    \
+        r->head = r->head + 1;                                                 \
+    }                                                                          \
+    bool name##_push(name *r, const type *src){                                \
+        type *dest = name##_reserve(r);                                        \
+        if(dest == NULL)                                                       \
+            return false;                                                      \
+        *dest = *src;                                                          \
+        name##_commit(r);                                                      \
+        return true;                                                           \
+    }                                                                          \
+    type *name##_peek(name *r){                                                \
+        unsigned int tail = r->tail;                                           \
+        if(tail == r->head)                                                    \
+            return NULL;                                                       \
+        return &r->items[tail & ((capacity) - 1)];                             \
+    }                                                                          \
+    void name##_release(name *r){                                              \
+        RING_BARRIER();                 /* Record read before release */       \
+        r->tail = r->tail + 1;                                                 \
+    }                                                                          \
+    bool name##_pop(name *r, type *dest){                                      \
+        type *src = name##_peek(r);                                            \
+        if(src == NULL)                                                        \
+            return false;                                                      \
+        *dest = *src;                                                          \
+        name##_release(r);                                                     \
+        return true;                                                           \
+    }
@@ -0,0 +1,157 @@
+/**
+ * @file spsc_buffer.h
+ * @brief Single producer single consumer ring buffer (no shared count)
+ * Only the producer writes head and only the consumer writes tail, so one side
+ * may be an ISR without disabling interrupts (16-bit loads and stores are
+ * atomic on MSP430). Indices run freely and are masked, so the size must be a
+ * power of two (at most 2^15).
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    volatile uint8_t *array;    // Array backing the buffer
+    unsigned int mask;          // Size of backing array - 1
+    volatile unsigned int head; // Total bytes written (producer only)
+    volatile unsigned int tail; // Total bytes read (consumer only)
+} spsc_buffer;
+
+// Contiguous region of a spsc buffer's backing array
+typedef struct {
+    volatile uint8_t *data;     // Start of region
+    unsigned int len;           // Number of bytes in region
+} spsc_span;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Check that a size is a power of two (use with #if or in static checks)
+#define SPSC_IS_POW2(n)     ((n) != 0 && ((n) & ((n) - 1)) == 0)
+
+// Number of bytes that can be read until buffer is empty
+#define SPSC_AVAIL_READ(sb) ((unsigned int)((sb)->head - (sb)->tail))
+
+// Number of bytes that can be written until buffer is full
+#define SPSC_AVAIL_WRITE(sb) ((sb)->mask + 1 - SPSC_AVAIL_READ(sb))
+
+// Check if buffer is full
+#define SPSC_FULL(sb)       (SPSC_AVAIL_READ(sb) > (sb)->mask)
+
+// Check if buffer is empty
+#define SPSC_EMPTY(sb)      ((sb)->head == (sb)->tail)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize a buffer with the given backing array
+ * @param sb Buffer to initialize
+ * @param backing_array Array to back the buffer
+ * @param len Length of array backing the buffer (power of two)
+ */
+void spsc_init(volatile spsc_buffer *sb, volatile uint8_t *backing_array, unsigned int len);
+
+/**
+ * Write a byte into the buffer (producer only)
+ * @param sb Buffer to write into
+ * @param src Byte to write
+ * @return true If successfully written
+ * @return false If buffer is full
+ */
+bool spsc_write(volatile spsc_buffer *sb, uint8_t src);
+
+/**
+ * Read a byte from the buffer (consumer only)
+ * @param sb Buffer to read from
+ * @param dest Pointer to destination to move read byte into
+ * @return true If successfully read
+ * @return false If buffer is empty
+ */
+bool spsc_read(volatile spsc_buffer *sb, uint8_t *dest);
+
+/**
+ * Write up to len bytes into the buffer (as many as fit; producer only)
+ * @param sb Buffer to write into
+ * @param src Bytes to write
+ * @param len Number of bytes in src
+ * @return Number of bytes written
+ */
+unsigned int spsc_write_block(volatile spsc_buffer *sb, const uint8_t *src, unsigned int len);
+
+/**
+ * Read up to len bytes from the buffer (as many as available; consumer only)
+ * @param sb Buffer to read from
+ * @param dest Destination for read bytes
+ * @param len Max number of bytes to read
+ * @return Number of bytes read
+ */
+unsigned int spsc_read_block(volatile spsc_buffer *sb, uint8_t *dest, unsigned int len);
+
+/**
+ * Get the free space of the buffer as (up to) two contiguous regions.
+ * Fill spans[0] first then spans[1], then call spsc_commit_write.
+ * @param sb Buffer to write into
+ * @param spans Filled with free regions (second has len 0 if not wrapped)
+ * @return Total free bytes (spans[0].len + spans[1].len)
+ */
+unsigned int spsc_peek_write(volatile spsc_buffer *sb, spsc_span spans[2]);
+
+/**
+ * Mark bytes filled in after spsc_peek_write as written (producer only)
+ * @param sb Buffer written into
+ * @param len Number of bytes filled in (at most value returned by spsc_peek_write)
+ */
+void spsc_commit_write(volatile spsc_buffer *sb, unsigned int len);
+
+/**
+ * Get the data in the buffer as (up to) two contiguous regions (oldest first)
+ * without removing it. Call spsc_commit_read to remove it.
+ * @param sb Buffer to read from
+ * @param spans Filled with data regions (second has len 0 if not wrapped)
+ * @return Total bytes available (spans[0].len + spans[1].len)
+ */
+unsigned int spsc_peek_read(volatile spsc_buffer *sb, spsc_span spans[2]);
+
+/**
+ * Remove bytes from the buffer after spsc_peek_read (consumer only)
+ * @param sb Buffer to remove bytes from
+ * @param len Number of bytes to remove (at most value returned by spsc_peek_read)
+ */
+void spsc_commit_read(volatile spsc_buffer *sb, unsigned int len);
@@ -0,0 +1,102 @@
+/**
+ * @file stats.h
+ * @brief Windowed statistics of samples (min, max, mean, standard deviation)
+ *
+ * Updated in constant time per sample with exact integer sums of the
+ * difference from the window's first sample (and of its square). Mean and
+ * variance are computed from the sums when the window ends, so no rounding
+ * builds up. A summary is produced at the end of each window.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define STATS_WINDOW_MS         60000       // Window length (ms)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+// Accumulator for one channel
+typedef struct {
+    int16_t min;
+    int16_t max;
+    int16_t first;                          // First sample (differences from it)
+    int32_t sum;                            // Sum of differences
+    uint64_t sum_sq;                        // Sum of squared differences
+} stats_acc;
+
+// Summary of one channel over a window (same units as samples)
+typedef struct {
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint16_t sd;                            // Standard deviation
+} stats_result;
+
+typedef struct {
+    unsigned int count;                     // Samples in window
+    stats_result temperature;
+    stats_result humidity;
+} stats_summary;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+// Summary of the last completed window
+extern stats_summary stats_last;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize statistics (start an empty window)
+ */
+void stats_init(void);
+
+/**
+ * Add a sample to the current window
+ * @param timestamp Time the sample completed (see timers_now)
+ * @param temperature Temperature (see aht10_temperature)
+ * @param humidity Humidity (see aht10_humidity)
+ * @return true if this sample ended a window (see stats_last) else false
+ */
+bool stats_add(uint32_t timestamp, int16_t temperature, unsigned int humidity);
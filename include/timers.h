@@ -42,7 +42,14 @@
 extern volatile uint32_t timers_now;
 
 // Counts 500ms interrupts. Used to derive 1sec timing
-extern volatile unsigned int timers_500_count;
+extern volatile uint8_t timers_500_count;
+
+// Time main loop has spent in LPM0 (see timers_sleep). In ms so it wraps
+// with timers_now (49 days), not after 9.5 hours as a TA1 tick count would.
+extern volatile uint32_t timers_sleep_ms;
+
+// Part of timers_sleep_ms under 1ms. In TA1 ticks (8us).
+extern volatile unsigned int timers_sleep_ticks;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -52,6 +59,9 @@ extern volatile unsigned int timers_500_count;
 #define TA1CCR0_OFFSET      1250    // 125kHz / 1250  = 100Hz int rate (10ms)
 #define TA1CCR1_OFFSET      12500   // 125kHz / 12500 = 10Hz int rate (100ms)
 #define TA1CCR2_OFFSET      62500   // 125kHz / 62500 = 2Hz int rate (500ms)
+#define TA0CCR1_OFFSET      100     // 1MHz / 100 = 10kHz (RS-485 turnaround)
+#define TA1_TICKS_PER_MS    125     // 125kHz
+#define TA1_RESYNC_MARGIN   16      // Time for a late CCR0 interrupt (128us)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -63,7 +73,28 @@ extern volatile unsigned int timers_500_count;
  */
 void timers_init(void);
 
+/**
+ * Enter LPM0 until an interrupt exits it. Time spent asleep is added to
+ * timers_sleep_ms.
+ */
+void timers_sleep(void);
+
+/**
+ * Catch up TA1 CCR0 after the CPU was held with interrupts disabled (e.g. a
+ * flash erase takes about 12ms, longer than the 10ms period). Periods missed
+ * are added to timers_now and CCR0 is moved forward so the pending interrupt
+ * schedules the next one in the future instead of after a timer wrap (0.5s).
+ * Call with interrupts disabled.
+ */
+void timers_resync(void);
+
 /**
  * Delay for the configured time then transition to the next bbi2c state
  */
 void timers_bbi2c_delay(void);
+
+/**
+ * Interrupt (TA0 CCR1) after TA0CCR1_OFFSET to check whether uca0uart has
+ * finished sending (see uca0uart_handle_txen)
+ */
+void timers_txen_delay(void);
@@ -0,0 +1,92 @@
+/**
+ * @file timesync.h
+ * @brief Host time synchronization. Maps timers_now to host time (ms since
+ * 1970) in 64 bits.
+ *
+ * The host sends its time ('Y' command); the device adopts it as the time at
+ * receipt and replies with its timers_now at receipt so the host can check
+ * the round trip. Until the first sync timesync_time is time since boot
+ * (without the 32-bit rollover of timers_now). The rate error of the clock
+ * (DCO, a few percent at most) is estimated from the error accumulated
+ * between syncs at least TIMESYNC_INTERVAL_MIN apart and corrected
+ * continuously.
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ * @version 1.0.0
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define TIMESYNC_INTERVAL_MIN   60000       // Min time to estimate drift (ms)
+#define TIMESYNC_DRIFT_MAX      50000       // Max drift (ppm). Larger is a step.
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+extern bool timesync_valid;                 // Host time received
+extern int32_t timesync_drift;              // Correction (ppm; + if clock slow)
+extern int32_t timesync_error;              // Host - predicted at last sync (ms)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initialize (time since boot, no drift correction)
+ */
+void timesync_init(void);
+
+/**
+ * Move the reference point to now. Must be called at least every 40 seconds
+ * (keeps the drift correction within 32 bits and handles timers_now rollover).
+ * @param now Current timers_now
+ */
+void timesync_update(uint32_t now);
+
+/**
+ * Corrected time
+ * @param now timers_now to convert (no earlier than last timesync_update)
+ * @return Host time in ms since 1970 if timesync_valid else ms since boot
+ */
+uint64_t timesync_time(uint32_t now);
+
+/**
+ * Adopt host time. Updates drift estimate.
+ * @param host Host time in ms since 1970 (at receipt)
+ * @param now timers_now at receipt
+ */
+void timesync_set(uint64_t host, uint32_t now);
@@ -3,7 +3,7 @@
  * @brief UART communication via UCA0
  *
  * Must configure pins correctly (see ports.h)
- * uca0uart_set_baud must change based on SMCLK rate (see system.h)
+ * UCA0UART_BRCLK (uca0uart.c) must match SMCLK rate (see system.c)
  *
  * @author Marcus Behel (mgbehel@ncsu.edu)
  * @version 1.0.0
@@ -37,14 +37,53 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <ring.h>
+#include <spsc_buffer.h>
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Macros
 ////////////////////////////////////////////////////////////////////////////////
 
-// Possible baud rates
+// Possible baud rates (divisors computed from UCA0UART_BRCLK in uca0uart.c)
 #define uca0uart_BUAD_9600   0
+#define uca0uart_BUAD_19200  1
+#define uca0uart_BUAD_38400  2
+#define uca0uart_BUAD_57600  3
+#define uca0uart_BUAD_115200 4
+
+#define UCA0UART_SEGMENTS    1           // Max queued segments (power of two)
+#define UCA0UART_WB_SIZE     32          // Write buffer size (longest message)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+// Caller owned data queued with uca0uart_write_segment (internal use)
+typedef struct {
+    const uint8_t *data;                 // Bytes to send next (not copied)
+    unsigned int len;                    // Number of bytes left
+    unsigned int mark;                   // Write buffer position to follow
+    volatile bool *done;                 // Set when sent (may be NULL)
+} uca0uart_segment;
+
+RING_DECLARE(uca0uart_segment_ring, uca0uart_segment, UCA0UART_SEGMENTS)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+// Drop counters (wrap)
+extern unsigned int uca0uart_tx_drop_msgs;      // Failed uca0uart_reserve calls
+extern unsigned int uca0uart_tx_drop_bytes;     // Bytes not fitting in write calls
+extern volatile unsigned int uca0uart_rx_drops; // Bytes received while full
+
+// High-water marks (most bytes ever queued) of write, priority and read buffers
+extern uint8_t uca0uart_wb_high;
+extern uint8_t uca0uart_pb_high;
+extern volatile uint8_t uca0uart_rb_high;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,14 +93,18 @@
 /**
  * Initialize pc comm subsystem including USCI port in use
  * @param baud Baud rate to initialize at
+ * @return true if set. false if not built in (9600 set; see uca0uart_set_buad)
  */
-void uca0uart_init(unsigned int baud);
+bool uca0uart_init(unsigned int baud);
 
 /**
- * Set baud rate
+ * Set baud rate. Rates not built in (UCA0UART_RATES in uca0uart.c; e.g.
+ * 115200, which needs a faster baud rate clock) are not supported and 9600
+ * is used instead.
  * @param baud Baud rate
+ * @return true if set. false if not supported (9600 set)
  */
-void uca0uart_set_buad(unsigned int baud);
+bool uca0uart_set_buad(unsigned int baud);
 
 /**
  * Copy a string into the internal write buffer (transmitted later)
@@ -85,6 +128,109 @@ bool uca0uart_write_byte(uint8_t b);
  */
 unsigned int uca0uart_write_bytes(uint8_t *data, unsigned int len);
 
+/**
+ * Format a signed fixed point value directly into the internal write buffer
+ * (see fmt.h). Nothing is written if it does not all fit.
+ * @param value Value to write (e.g. 2345 is "23.45" with 2 decimals)
+ * @param decimals Digits after the decimal point (0 for no point)
+ * @param width Min length (padded with leading spaces)
+ * @return Number of bytes written
+ */
+unsigned int uca0uart_write_fixed(int32_t value, unsigned int decimals, unsigned int width);
+
+/**
+ * Format an unsigned 64-bit value directly into the internal write buffer
+ * (see fmt_uint64). Nothing is written if it does not all fit.
+ * @param value Value to write
+ * @return Number of bytes written
+ */
+unsigned int uca0uart_write_uint64(uint64_t value);
+
+/**
+ * Get the free space of the internal write buffer to fill in place (e.g. to
+ * encode a frame without a copy). Call uca0uart_commit_write when filled.
+ * @param spans Filled with free regions (see spsc_peek_write)
+ */
+void uca0uart_peek_write(spsc_span spans[2]);
+
+/**
+ * Send bytes filled in after uca0uart_peek_write
+ * @param len Number of bytes filled in (spans[0] first)
+ */
+void uca0uart_commit_write(unsigned int len);
+
+/**
+ * Reserve space for a whole message in the internal write buffer. If true, the
+ * next len bytes written are guaranteed to fit (write them then call
+ * uca0uart_commit). If false, nothing should be written (counted as a drop).
+ * @param len Length of the whole message
+ * @return true if there is space for len bytes else false
+ */
+bool uca0uart_reserve(unsigned int len);
+
+/**
+ * End a message started with uca0uart_reserve
+ */
+void uca0uart_commit(void);
+
+/**
+ * Sleep in LPM0 until len bytes are free in the internal write buffer
+ * Call from the main loop only (not an ISR). Interrupts must be enabled.
+ * @param len Number of bytes needed
+ * @return true once space available. false if len is larger than the buffer
+ */
+bool uca0uart_wait_avail(unsigned int len);
+
+/**
+ * Queue bytes ahead of everything in the internal write buffer. Use for
+ * urgent messages. They are sent once the message being sent ends (see
+ * uca0uart_set_message_end), so a message written in several calls must end
+ * with that byte or priority bytes wait until a later message does.
+ * @param data Buffer to copy from
+ * @param len Number of bytes to copy from buffer
+ * @return true if all bytes queued. false if none were (not enough space)
+ */
+bool uca0uart_write_priority(uint8_t *data, unsigned int len);
+
+/**
+ * Set the byte that ends every message written (text line end '\n' after
+ * uca0uart_init; 0x00 for binary frames). Priority bytes are only sent
+ * after it.
+ * @param b Last byte of a message
+ */
+void uca0uart_set_message_end(uint8_t b);
+
+/**
+ * End a message that does not end with the message end byte (e.g. a history
+ * or flash dump). Priority bytes are sent once everything written so far
+ * (including queued segments) has been sent.
+ */
+void uca0uart_end_message(void);
+
+/**
+ * Queue caller owned bytes to be sent directly from where they are (not
+ * copied). They are sent after everything already written and before anything
+ * written later. The data must not change until sent.
+ * @param data Bytes to send (e.g. constant in flash or a caller's buffer)
+ * @param len Number of bytes
+ * @param done If not NULL, set true by the TX ISR once all bytes are sent (the
+ *             buffer may then be reused). Set false before calling.
+ * @return true if queued. false if too many segments already queued.
+ */
+bool uca0uart_write_segment(const uint8_t *data, unsigned int len, volatile bool *done);
+
+/**
+ * Number of segments that can currently be queued
+ * @return Free entries in the segment queue
+ */
+unsigned int uca0uart_segment_avail(void);
+
+/**
+ * Number of bytes that can currently be written without any being dropped
+ * @return Free space in the internal write buffer
+ */
+unsigned int uca0uart_write_avail(void);
+
 /**
  * Read one byte from the internal read buffer
  * @param dest Where to move read byte
@@ -102,8 +248,16 @@ unsigned int uca0uart_read_bytes(uint8_t *dest, unsigned int count);
 
 /**
  * Call from ISR when byte written
+ * @return true if the ISR should exit LPM0 (see uca0uart_wait_avail)
+ */
+bool uca0uart_handle_write(void);
+
+/**
+ * Call from a timer ISR shortly after transmit stops (TX interrupt disabled)
+ * Releases the RS-485 driver (RS485_TXEN) once the last byte has been sent.
+ * @return true if done, false if still sending (call again later)
  */
-void uca0uart_handle_write(void);
+bool uca0uart_handle_txen(void);
 
 /**
  * Call from ISR when byte read
@@ -0,0 +1,97 @@
+/**
+ * @file adaptive.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <adaptive.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+bool adaptive_enabled;
+unsigned int adaptive_interval;
+
+unsigned int adaptive_ticks;                // Ticks since last sample
+bool adaptive_have_ref;                     // Reference sample valid
+uint32_t adaptive_ref_ts;                   // Reference sample timestamp
+int16_t adaptive_ref_temp;                  // Reference sample temperature
+unsigned int adaptive_ref_hum;              // Reference sample humidity
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Check if change over dt_ms exceeds the given rate (per second)
+ */
+bool adaptive_fast(int32_t delta, uint32_t dt_ms, unsigned int rate){
+    if(delta < 0)
+        delta = -delta;
+    return (uint32_t)delta * 1000 > (uint32_t)rate * dt_ms;
+}
+
+void adaptive_init(void){
+    adaptive_enabled = false;
+    adaptive_interval = ADAPTIVE_SLOW;
+    adaptive_ticks = 0;
+    adaptive_have_ref = false;
+}
+
+bool adaptive_tick(void){
+    adaptive_ticks++;
+    if(adaptive_ticks < adaptive_interval)
+        return false;
+    adaptive_ticks = 0;
+    return true;
+}
+
+void adaptive_update(uint32_t timestamp, int16_t temperature, unsigned int humidity){
+    uint32_t dt = timestamp - adaptive_ref_ts;
+
+    if(adaptive_have_ref && dt < ADAPTIVE_BASE_MS)
+        return;                             // Too soon to measure rate
+
+    if(adaptive_have_ref){
+        if(adaptive_fast((int32_t)temperature - adaptive_ref_temp, dt, ADAPTIVE_TEMP_RATE) ||
+                adaptive_fast((int32_t)humidity - adaptive_ref_hum, dt, ADAPTIVE_HUM_RATE)){
+            // Changing. Sample as fast as possible.
+            adaptive_interval = ADAPTIVE_FAST;
+        }else{
+            // Flat. Decay toward slowest rate.
+            adaptive_interval += (adaptive_interval >> 2) + 1;
+            if(adaptive_interval > ADAPTIVE_SLOW)
+                adaptive_interval = ADAPTIVE_SLOW;
+        }
+    }
+
+    adaptive_have_ref = true;
+    adaptive_ref_ts = timestamp;
+    adaptive_ref_temp = temperature;
+    adaptive_ref_hum = humidity;
+}
@@ -128,8 +128,10 @@
  *                  └───────┘
  */
 
+#include <stddef.h>
 #include <aht10.h>
 #include <timers.h>
+#include <calib.h>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -148,7 +150,6 @@
 
 
 // I2C definitions
-#define ADDR_DEF            0x38            // Default address
 #define CMD_CALIBRATE       0xE1            // Calibrate command
 #define CMD_TRIGGER         0xAC            // Trigger read command
 #define CMD_RESET           0xBA            // Reset command
@@ -159,16 +160,24 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// Globals
 ////////////////////////////////////////////////////////////////////////////////
-unsigned int aht10_temperature;
+int16_t aht10_temperature;
 unsigned int aht10_humidity;
-unsigned int aht10_ec;
-uint32_t aht10_last_read;
-bbi2c_transaction aht10_trans;
+uint8_t aht10_ec;
 
-unsigned int aht10_state;                   // Current state
-uint8_t aht10_wb[3];                        // Write buffer
+uint8_t aht10_state;                        // Current state
 uint8_t aht10_rb[6];                        // Read buffer
 
+// Commands and transactions (constant so they stay in flash, not RAM)
+const uint8_t aht10_cmd_reset[] = {CMD_RESET};
+const uint8_t aht10_cmd_calibrate[] = {CMD_CALIBRATE, 0x08, 0x00};
+const uint8_t aht10_cmd_trigger[] = {CMD_TRIGGER, 0x33, 0x00};
+
+const bbi2c_transaction aht10_reset = {AHT10_ADDR, aht10_cmd_reset, sizeof(aht10_cmd_reset), NULL, 0};
+const bbi2c_transaction aht10_calibrate = {AHT10_ADDR, aht10_cmd_calibrate, sizeof(aht10_cmd_calibrate), NULL, 0};
+const bbi2c_transaction aht10_trigger = {AHT10_ADDR, aht10_cmd_trigger, sizeof(aht10_cmd_trigger), NULL, 0};
+const bbi2c_transaction aht10_status = {AHT10_ADDR, NULL, 0, aht10_rb, 1};
+const bbi2c_transaction aht10_data = {AHT10_ADDR, NULL, 0, aht10_rb, 6};
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Functions
@@ -180,49 +189,31 @@ uint8_t aht10_rb[6];                        // Read buffer
  */
 void aht10_actions(void){
     uint32_t tmp;
+    int16_t cal;
     switch(aht10_state){
     case STATE_RST:
         // Send reset command
-        aht10_wb[0] = CMD_RESET;
-        aht10_trans.write_count = 1;
-        aht10_trans.read_count = 0;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_reset);
         break;
     case STATE_CAL:
         // Send calibrate command
-        aht10_wb[0] = CMD_CALIBRATE;
-        aht10_wb[1] = 0x08;
-        aht10_wb[2] = 0x00;
-        aht10_trans.write_count = 3;
-        aht10_trans.read_count = 0;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_calibrate);
         break;
     case STATE_CAL_STA:
         // Read status byte. Wait until not busy and check calibrate fail
-        aht10_trans.write_count = 0;
-        aht10_trans.read_count = 1;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_status);
         break;
     case STATE_TRG:
         // Send trigger command
-        aht10_wb[0] = CMD_TRIGGER;
-        aht10_wb[1] = 0x33;
-        aht10_wb[2] = 0x00;
-        aht10_trans.write_count = 3;
-        aht10_trans.read_count = 0;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_trigger);
         break;
     case STATE_TRG_STA:
         // Read status byte. Wait until not busy
-        aht10_trans.write_count = 0;
-        aht10_trans.read_count = 1;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_status);
         break;
     case STATE_READ:
         // Read raw sensor data
-        aht10_trans.write_count = 0;
-        aht10_trans.read_count = 6;
-        bbi2c_perform(&aht10_trans);
+        bbi2c_perform(&aht10_data);
         break;
     case STATE_IDLE:
         // Waiting for user to request a read (aht10_read)
@@ -250,8 +241,13 @@ void aht10_actions(void){
         // Mult by 625: 625x = 512x + 64x + 32x + 16x + x
         tmp = (tmp << 9) + (tmp << 6) + (tmp << 5) + (tmp << 4) + tmp;
 
-        // Divide by 2^16
-        aht10_humidity = tmp >> 16;
+        // Divide by 2^16 then apply calibration (limit to 0% - 100%)
+        cal = calib_apply(&calib->humidity, tmp >> 16);
+        if(cal < 0)
+            cal = 0;
+        if(cal > 10000)
+            cal = 10000;
+        aht10_humidity = cal;
 
 
         // ---------------------------------------------------------------------
@@ -274,18 +270,14 @@ void aht10_actions(void){
         // Mult by 625: 625x = 512x + 64x + 32x + 16x + x
         tmp = (tmp << 9) + (tmp << 6) + (tmp << 5) + (tmp << 4) + tmp;
 
-        // Divide by 2^15
-        aht10_temperature = (tmp >> 15) - 5000;
+        // Divide by 2^15 then apply calibration
+        aht10_temperature = calib_apply(&calib->temperature, (tmp >> 15) - 5000);
 
         break;
     }
 }
 
 void aht10_init(void){
-    aht10_trans.address = ADDR_DEF;         // Set device address
-    aht10_trans.write_buf = aht10_wb;       // Configure write buffer
-    aht10_trans.read_buf = aht10_rb;        // Configure read buffer
-
     aht10_ec = AHT10_EC_NONE;               // No error (yet)
 
     aht10_state = STATE_RST;                // Set initial state
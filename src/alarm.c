@@ -0,0 +1,79 @@
+/**
+ * @file alarm.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <alarm.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+uint8_t alarm_state;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Evaluate one high / low pair
+ * @return New state of the pair's bits
+ */
+unsigned int alarm_eval(int16_t v, int16_t high, int16_t low, int16_t hyst,
+        unsigned int high_bit, unsigned int low_bit){
+    unsigned int state = alarm_state & (high_bit | low_bit);
+
+    if(v > high)
+        state |= high_bit;
+    else if(v < high - hyst)
+        state &= ~high_bit;
+
+    if(v < low)
+        state |= low_bit;
+    else if(v > low + hyst)
+        state &= ~low_bit;
+
+    return state;
+}
+
+void alarm_init(void){
+    alarm_state = 0;
+}
+
+unsigned int alarm_check(int16_t temperature, unsigned int humidity){
+    unsigned int state, changed;
+
+    state = alarm_eval(temperature, ALARM_DEF_TEMP_HIGH, ALARM_DEF_TEMP_LOW,
+            ALARM_DEF_TEMP_HYST, ALARM_TEMP_HIGH, ALARM_TEMP_LOW);
+    state |= alarm_eval(humidity, ALARM_DEF_HUM_HIGH, ALARM_DEF_HUM_LOW,
+            ALARM_DEF_HUM_HYST, ALARM_HUM_HIGH, ALARM_HUM_LOW);
+
+    changed = state ^ alarm_state;
+    alarm_state = state;
+    return changed;
+}
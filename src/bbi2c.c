@@ -44,11 +44,11 @@
 /// Globals
 ////////////////////////////////////////////////////////////////////////////////
 
-volatile unsigned int bbi2c_state;
-volatile unsigned int bbi2c_bits;
-volatile unsigned int bbi2c_pos;
+volatile uint8_t bbi2c_state;
+volatile uint8_t bbi2c_bits;
+volatile uint8_t bbi2c_pos;
 volatile uint8_t bbi2c_buf;
-bbi2c_transaction *bbi2c_trans;
+const bbi2c_transaction *bbi2c_trans;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -61,7 +61,7 @@ void bbi2c_init(void){
     PORTS_SCL_HIGH;
 }
 
-void bbi2c_perform(bbi2c_transaction *trans){
+void bbi2c_perform(const bbi2c_transaction *trans){
     bbi2c_trans = trans;
     bbi2c_state = 0;
 
@@ -0,0 +1,118 @@
+/**
+ * @file calib.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <calib.h>
+#include <flash.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define CALIB_WORDS         6               // Magic, 4 values, checksum
+
+// Stored calibration in info flash
+#define CALIB_FLASH         ((const uint16_t*)(uintptr_t)CALIB_ADDR)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+const calib_data *calib;
+
+// No correction (used if flash is missing or corrupt)
+const calib_data calib_none = {{0, 0}, {0, 0}};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Checksum of words (chosen so sum of all words including checksum is 0)
+ */
+uint16_t calib_checksum(const uint16_t *words, unsigned int count){
+    uint16_t sum = 0;
+    unsigned int i;
+    for(i = 0; i < count; ++i)
+        sum += words[i];
+    return -sum;
+}
+
+void calib_init(void){
+    const uint16_t *f = CALIB_FLASH;
+
+    // Used in place (values follow the magic word in calib_data layout)
+    if(f[0] == CALIB_MAGIC && calib_checksum(f, CALIB_WORDS - 1) == f[CALIB_WORDS - 1])
+        calib = (const calib_data*)&f[1];
+    else
+        calib = &calib_none;                // Missing or corrupt
+}
+
+void calib_store(const calib_data *data){
+    uint16_t words[CALIB_WORDS];
+
+    words[0] = CALIB_MAGIC;
+    words[1] = data->temperature.offset;
+    words[2] = data->temperature.gain;
+    words[3] = data->humidity.offset;
+    words[4] = data->humidity.gain;
+    words[5] = calib_checksum(words, CALIB_WORDS - 1);
+
+    flash_erase(CALIB_FLASH);
+    flash_write(CALIB_FLASH, words, CALIB_WORDS);
+    calib_init();
+}
+
+int16_t calib_apply(const calib_channel *ch, int16_t value){
+    int32_t x = value;
+    int32_t acc = 0;
+    uint16_t g;
+
+    // acc = x * |gain| using shift and add (one add per set bit of gain)
+    g = ch->gain < 0 ? -(int32_t)ch->gain : ch->gain;
+    while(g != 0){
+        if(g & 1)
+            acc += x;
+        x <<= 1;
+        g >>= 1;
+    }
+    acc >>= 15;                             // Q15
+
+    if(ch->gain < 0)
+        acc = -acc;
+
+    // Sum in 32 bits and saturate to int16
+    acc += (int32_t)value + ch->offset;
+    if(acc > INT16_MAX)
+        return INT16_MAX;
+    if(acc < INT16_MIN)
+        return INT16_MIN;
+    return acc;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file change.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <change.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+unsigned int change_temp_band;
+unsigned int change_hum_band;
+unsigned int change_heartbeat;
+
+bool change_reported;                       // Anything reported yet
+uint32_t change_last_ts;                    // Last reported timestamp
+int16_t change_last_temp;                   // Last reported temperature
+unsigned int change_last_hum;               // Last reported humidity
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+void change_init(void){
+    change_temp_band = CHANGE_DEF_TEMP_BAND;
+    change_hum_band = CHANGE_DEF_HUM_BAND;
+    change_heartbeat = CHANGE_DEF_HEARTBEAT;
+    change_reset();
+}
+
+void change_reset(void){
+    change_reported = false;
+}
+
+bool change_check(uint32_t timestamp, int16_t temperature, unsigned int humidity){
+    int32_t dt = (int32_t)temperature - change_last_temp;
+    int32_t dh = (int32_t)humidity - change_last_hum;
+
+    if(change_reported &&
+            dt <= (int32_t)change_temp_band && dt >= -(int32_t)change_temp_band &&
+            dh <= (int32_t)change_hum_band && dh >= -(int32_t)change_hum_band &&
+            timestamp - change_last_ts < (uint32_t)change_heartbeat * 1000)
+        return false;                       // Inside deadband. Not due.
+
+    change_reported = true;
+    change_last_ts = timestamp;
+    change_last_temp = temperature;
+    change_last_hum = humidity;
+    return true;
+}
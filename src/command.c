@@ -0,0 +1,250 @@
+/**
+ * @file command.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <command.h>
+#include <uca0uart.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Parser states
+#define STATE_BYTE          0           // Waiting for a command byte
+#define STATE_ARGS          1           // Collecting argument bytes
+#define STATE_LINE          2           // Collecting a line command
+#define STATE_SKIP          3           // Line too long. Discard to end.
+
+// Argument a line command takes
+#define ARG_NONE            0
+#define ARG_NUMBER          1           // Signed decimal number
+#define ARG_FORMAT          2           // "BIN" or "TEXT"
+
+#define IS_EOL(b)           ((b) == '\r' || (b) == '\n')
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Typedefs
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    char name[6];                       // Upper case, null terminated
+    uint8_t id;
+    uint8_t arg;                        // ARG_*
+} command_name;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+const command_name command_names[] = {
+    { "RATE",   COMMAND_RATE,   ARG_NUMBER },
+    { "READ",   COMMAND_READ,   ARG_NONE },
+    { "DUMP",   COMMAND_DUMP,   ARG_NONE },
+    { "STATS",  COMMAND_STATS,  ARG_NONE },
+    { "FMT",    COMMAND_FORMAT, ARG_FORMAT },
+    { "NODE",   COMMAND_NODE,   ARG_NUMBER },
+    { "TBAND",  COMMAND_TBAND,  ARG_NUMBER },
+    { "HBAND",  COMMAND_HBAND,  ARG_NUMBER },
+};
+
+uint8_t command_state;                  // STATE_*
+uint8_t command_pending;                // Command byte waiting for args
+uint8_t command_len;                    // Chars / argument bytes received
+uint8_t command_buf[COMMAND_LINE_MAX];  // Line chars or argument bytes
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Number of argument bytes a single byte command takes
+ */
+unsigned int command_arg_count(uint8_t b){
+    switch(b){
+    case COMMAND_CALIB_SET:
+        return 8;                       // Calibration (4x 16-bit)
+    case COMMAND_SYNC:
+        return 8;                       // Time sync (64-bit host time)
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Compare word in command_buf to an upper case name
+ * @return true if equal
+ */
+bool command_match(unsigned int start, unsigned int end, const char *name){
+    while(start < end){
+        if(*name++ != command_buf[start++])
+            return false;
+    }
+    return *name == '\0';
+}
+
+/**
+ * Parse a signed decimal number from command_buf
+ * @return true if valid (false if out of int32 range)
+ */
+bool command_number(unsigned int start, unsigned int end, int32_t *dest){
+    bool neg = false;
+    int32_t value = 0;
+    uint8_t digit;
+
+    if(start < end && command_buf[start] == '-'){
+        neg = true;
+        start++;
+    }
+    if(start == end)
+        return false;
+    while(start < end){
+        if(command_buf[start] < '0' || command_buf[start] > '9')
+            return false;
+        digit = command_buf[start++] - '0';
+        if(value > INT32_MAX / 10 ||
+                (value == INT32_MAX / 10 && digit > INT32_MAX % 10))
+            return false;               // value * 10 + digit would overflow
+        value = value * 10 + digit;
+    }
+    *dest = neg ? -value : value;
+    return true;
+}
+
+/**
+ * Parse a complete line (in command_buf, without '$' and CR / LF)
+ * Line is at most COMMAND_LINE_MAX chars so this is bounded.
+ */
+void command_parse(command *cmd){
+    unsigned int i, name_end, arg_start;
+    const command_name *n;
+
+    cmd->id = COMMAND_INVALID;
+    cmd->arg = 0;
+
+    // Name then (optionally) spaces and argument
+    for(name_end = 0; name_end < command_len && command_buf[name_end] != ' '; name_end++);
+    for(arg_start = name_end; arg_start < command_len && command_buf[arg_start] == ' '; arg_start++);
+
+    for(i = 0; i < sizeof(command_names) / sizeof(command_names[0]); i++){
+        n = &command_names[i];
+        if(!command_match(0, name_end, n->name))
+            continue;
+        switch(n->arg){
+        case ARG_NONE:
+            if(arg_start != command_len)
+                return;
+            break;
+        case ARG_NUMBER:
+            if(!command_number(arg_start, command_len, &cmd->arg))
+                return;
+            break;
+        case ARG_FORMAT:
+            if(command_match(arg_start, command_len, "BIN"))
+                cmd->arg = 1;
+            else if(!command_match(arg_start, command_len, "TEXT"))
+                return;
+            break;
+        }
+        cmd->id = n->id;
+        return;
+    }
+}
+
+void command_init(void){
+    command_state = STATE_BYTE;
+    command_len = 0;
+}
+
+bool command_feed(uint8_t b, command *cmd){
+    unsigned int i;
+
+    switch(command_state){
+    case STATE_ARGS:
+        command_buf[command_len++] = b;
+        if(command_len < command_arg_count(command_pending))
+            return false;
+        cmd->id = command_pending;
+        cmd->arg = 0;
+        for(i = 0; i < command_len; i++)
+            cmd->args[i] = command_buf[i];
+        command_state = STATE_BYTE;
+        return true;
+    case STATE_LINE:
+        if(IS_EOL(b)){
+            command_parse(cmd);
+            command_state = STATE_BYTE;
+            return true;
+        }
+        if(command_len == COMMAND_LINE_MAX){
+            command_state = STATE_SKIP;
+            return false;
+        }
+        if(b >= 'a' && b <= 'z')
+            b -= 'a' - 'A';             // Names are not case sensitive
+        command_buf[command_len++] = b;
+        return false;
+    case STATE_SKIP:
+        if(!IS_EOL(b))
+            return false;
+        cmd->id = COMMAND_INVALID;
+        cmd->arg = 0;
+        command_state = STATE_BYTE;
+        return true;
+    default:
+        if(IS_EOL(b))
+            return false;               // Ignore line endings between commands
+        if(b >= COMMAND_RATE)
+            return false;               // Would alias a line command id
+        command_len = 0;
+        if(b == COMMAND_START){
+            command_state = STATE_LINE;
+            return false;
+        }
+        if(command_arg_count(b) != 0){
+            command_pending = b;
+            command_state = STATE_ARGS;
+            return false;
+        }
+        cmd->id = b;
+        cmd->arg = 0;
+        return true;
+    }
+}
+
+bool command_next(command *cmd){
+    uint8_t b;
+    while(uca0uart_read_byte(&b)){
+        if(command_feed(b, cmd))
+            return true;
+    }
+    return false;
+}
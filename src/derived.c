@@ -0,0 +1,202 @@
+/**
+ * @file derived.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <derived.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Fixed point constants (Qn = value * 2^n)
+#define MAGNUS_B_Q12        72172           // 17.62
+#define MAGNUS_C            24312           // 243.12 deg C (x100)
+#define MAGNUS_ES0          6112            // 6.112 hPa (x1000)
+#define LN2_Q12             2839            // ln(2)
+#define LOG2E_Q12           5909            // log2(e)
+#define LOG2_10000_Q14      217706          // log2(10000)
+#define KELVIN              27315           // 273.15 K (x100)
+#define AH_FACTOR           21674           // 216.74 g K / (m^3 hPa) (x100)
+
+// Heat index (Rothfusz regression, Celsius). T in 0.1 deg C, R in 0.1 %
+// HI = B0(T) + R * (B1(T) + R * B2(T))
+#define HI_MIN_T            2670            // Below this HI = T (x100)
+#define HI_MAX_T            5000            // Clamp above this (x100)
+#define HI_K1               -575714         // c1 (Q16)
+#define HI_K2               10560           // c2 / 10 (Q16)
+#define HI_K5               -2065           // c5 / 100 (Q24)
+#define HI_K3               153259          // c3 (Q16)
+#define HI_K4               -15321          // c4 / 10 (Q20)
+#define HI_K7               5937            // c7 / 100 (Q28)
+#define HI_K6               -275563         // c6 (Q24)
+#define HI_K8               1217            // c8 / 10 (Q24)
+#define HI_K9               -2462           // c9 / 100 (Q36)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+// log2(1 + i/32) (Q14)
+const uint16_t derived_log2_table[33] = {
+        0,   727,  1433,  2118,  2784,  3432,  4062,  4676,
+     5274,  5858,  6428,  6984,  7527,  8059,  8578,  9086,
+     9584, 10071, 10549, 11017, 11476, 11926, 12368, 12802,
+    13228, 13646, 14057, 14461, 14858, 15249, 15634, 16012,
+    16384
+};
+
+// 2^(i/32) (Q14)
+const uint16_t derived_exp2_table[33] = {
+    16384, 16743, 17109, 17484, 17867, 18258, 18658, 19066,
+    19484, 19911, 20347, 20792, 21247, 21713, 22188, 22674,
+    23170, 23678, 24196, 24726, 25268, 25821, 26386, 26964,
+    27554, 28158, 28774, 29405, 30048, 30706, 31379, 32066,
+    32768
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Base 2 logarithm
+ * @param x Value (must be > 0)
+ * @return log2(x) (Q14)
+ */
+int32_t derived_log2(uint16_t x){
+    int32_t n = 15;
+    unsigned int idx, frac;
+
+    // Normalize so MSB is bit 15. n = integer part of log2
+    while(!(x & 0x8000)){
+        x <<= 1;
+        n--;
+    }
+
+    // Interpolate fractional part from table (5 bit index, 10 bit fraction)
+    idx = (x >> 10) & 0x1F;
+    frac = x & 0x3FF;
+    return (n << 14) + derived_log2_table[idx] +
+            (((uint32_t)(derived_log2_table[idx + 1] - derived_log2_table[idx]) * frac) >> 10);
+}
+
+/**
+ * Magnus term b * T / (c + T) (equal to ln(es / 6.112 hPa))
+ * @param t Temperature (deg C x100)
+ * @return Magnus term (Q12)
+ */
+int32_t derived_magnus(int16_t t){
+    return ((int32_t)MAGNUS_B_Q12 * t) / ((int32_t)MAGNUS_C + t);
+}
+
+/**
+ * Saturation vapor pressure
+ * @param magnus Magnus term (Q12; see derived_magnus)
+ * @return Saturation vapor pressure (hPa x100)
+ */
+uint32_t derived_es(int32_t magnus){
+    int32_t y, ip;
+    unsigned int fp, idx, frac;
+    uint32_t m;
+
+    // es = 6.112 * e^magnus = 6.112 * 2^(magnus * log2(e))
+    y = (magnus * LOG2E_Q12) >> 12;
+    ip = y >> 12;                           // Integer part (floor)
+    fp = y & 0xFFF;                         // Fractional part (Q12)
+
+    // Interpolate 2^fp from table (5 bit index, 7 bit fraction)
+    idx = fp >> 7;
+    frac = fp & 0x7F;
+    m = derived_exp2_table[idx] +
+            (((uint32_t)(derived_exp2_table[idx + 1] - derived_exp2_table[idx]) * frac) >> 7);
+
+    // ip is small (magnus is under 7 up to 150 deg C)
+    return (((uint32_t)MAGNUS_ES0 * m) >> (14 - ip)) / 10;
+}
+
+int16_t derived_dew_point(int16_t temperature, unsigned int humidity){
+    int32_t gamma;
+
+    if(humidity == 0)
+        humidity = 1;                       // Avoid log(0)
+    if(humidity > 10000)
+        humidity = 10000;
+
+    // gamma = ln(RH / 100%) + b * T / (c + T)
+    gamma = derived_log2(humidity) - LOG2_10000_Q14;
+    gamma = (gamma * LN2_Q12) >> 14;
+    gamma += derived_magnus(temperature);
+
+    // Td = c * gamma / (b - gamma)
+    return ((int32_t)MAGNUS_C * gamma) / (MAGNUS_B_Q12 - gamma);
+}
+
+unsigned int derived_abs_humidity(int16_t temperature, unsigned int humidity){
+    uint32_t es, e, tk, ah;
+
+    if(humidity > 10000)
+        humidity = 10000;
+
+    // Vapor pressure e = es * RH (hPa x100). Split so es * RH does not
+    // overflow 32 bits above 100 deg C.
+    es = derived_es(derived_magnus(temperature));
+    e = (es / 100) * humidity / 100 + (es % 100) * humidity / 10000;
+
+    // AH = 216.74 * e / T(K). Split the same way; saturates above 655.35.
+    tk = (int32_t)KELVIN + temperature;
+    if(e / tk > 0xFFFF / AH_FACTOR)
+        return 0xFFFF;
+    ah = (e / tk) * AH_FACTOR + ((e % tk) * AH_FACTOR) / tk;
+    return ah > 0xFFFF ? 0xFFFF : ah;
+}
+
+int16_t derived_heat_index(int16_t temperature, unsigned int humidity){
+    int32_t t, t2, r, b0, b1, b2, hi;
+
+    if(temperature < HI_MIN_T)
+        return temperature;
+    if(temperature > HI_MAX_T)
+        temperature = HI_MAX_T;
+    if(humidity > 10000)
+        humidity = 10000;
+
+    t = (temperature + 5) / 10;             // 0.1 deg C, rounded
+    t2 = t * t;
+    r = (humidity + 5) / 10;                // 0.1 %, rounded
+
+    b0 = HI_K1 + HI_K2 * t + ((HI_K5 * t2) >> 8);                       // Q16
+    b1 = HI_K3 + ((HI_K4 * t) >> 4) + ((HI_K7 * t2) >> 12);             // Q16
+    b2 = HI_K6 + HI_K8 * t + ((HI_K9 * t2) >> 12);                      // Q24
+
+    hi = b1 + (((r * b2) / 10) >> 8);                                   // Q16
+    hi = b0 + (r * hi) / 10;                                            // Q16
+    return (hi * 100) >> 16;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file filter.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <filter.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+uint8_t filter_type;
+int16_t filter_temperature;
+unsigned int filter_humidity;
+
+filter_channel filter_temp;                 // Temperature channel
+filter_channel filter_hum;                  // Humidity channel
+uint8_t filter_pos;                         // Next tap to write
+uint8_t filter_count;                       // Samples since last report
+bool filter_primed;                         // Taps filled
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Median of the most recent n (odd; up to 5) taps of a channel
+ */
+int16_t filter_median(filter_channel *ch, unsigned int n){
+    int16_t v[5], tmp;
+    unsigned int i, j, pos = filter_pos + 1;  // Newest tap is at filter_pos
+
+    // Copy most recent n taps (insertion sort as they are copied)
+    for(i = 0; i < n; ++i){
+        pos = (pos == 0 ? FILTER_TAPS : pos) - 1;
+        tmp = ch->taps[pos];
+        for(j = i; j > 0 && v[j - 1] > tmp; --j)
+            v[j] = v[j - 1];
+        v[j] = tmp;
+    }
+    return v[n / 2];
+}
+
+/**
+ * Add a sample to a channel and return the filtered value
+ */
+int16_t filter_channel_add(filter_channel *ch, int16_t x){
+    unsigned int i;
+    int32_t sum;
+
+    if(filter_type == FILTER_NONE)
+        return x;
+
+    if(filter_type == FILTER_EMA){
+        if(!filter_primed)
+            ch->ema = (int32_t)x << 4;      // As if it had always been x
+        ch->ema += (((int32_t)x << 4) - ch->ema) >> FILTER_EMA_SHIFT;
+        return (ch->ema + 8) >> 4;
+    }
+
+    if(!filter_primed){
+        // First sample. Fill taps as if it had always been this value.
+        for(i = 0; i < FILTER_TAPS; ++i)
+            ch->taps[i] = x;
+    }
+    ch->taps[filter_pos] = x;
+
+    switch(filter_type){
+    case FILTER_MA:
+        sum = 0;
+        for(i = 0; i < FILTER_TAPS; ++i)
+            sum += ch->taps[i];
+        // Rounded to nearest (division truncates toward zero)
+        if(sum < 0)
+            sum -= FILTER_TAPS / 2;
+        else
+            sum += FILTER_TAPS / 2;
+        return sum / FILTER_TAPS;
+    case FILTER_MEDIAN3:
+        return filter_median(ch, 3);
+    case FILTER_MEDIAN5:
+        return filter_median(ch, 5);
+    default:
+        return x;
+    }
+}
+
+void filter_init(void){
+    filter_set_type(FILTER_NONE);
+}
+
+void filter_set_type(unsigned int type){
+    filter_type = type;
+    filter_pos = 0;
+    filter_count = 0;
+    filter_primed = false;
+}
+
+bool filter_add(int16_t temperature, unsigned int humidity){
+    int16_t t, h;
+
+    t = filter_channel_add(&filter_temp, temperature);
+    h = filter_channel_add(&filter_hum, humidity);
+    filter_primed = true;
+    if(++filter_pos == FILTER_TAPS)
+        filter_pos = 0;
+
+    // Decimate (only when filtering)
+    filter_count++;
+    if(filter_type != FILTER_NONE && filter_count < FILTER_DECIMATE)
+        return false;
+    filter_count = 0;
+
+    filter_temperature = t;
+    filter_humidity = h;
+    return true;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file flash.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <flash.h>
+#include <msp430.h>
+#include <system.h>
+#include <timers.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+// Flash timing generator must be 257kHz - 476kHz
+// MCLK = 8MHz (see system.c). 8MHz / 20 = 400kHz. FNx = divider - 1 = 19
+#define FLASH_CLOCK         (FSSEL_1 + FN4 + FN1 + FN0)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+void flash_init(void){
+    FCTL2 = FWKEY + FLASH_CLOCK;        // Flash clock from MCLK / 20
+}
+
+void flash_erase(const void *addr){
+    DISABLE_INTERRUPTS;
+    while(FCTL3 & BUSY);                // Wait for any previous operation
+    FCTL3 = FWKEY;                      // Unlock (leaves info A locked)
+    FCTL1 = FWKEY + ERASE;              // Segment erase mode
+    *(volatile uint16_t*)addr = 0;      // Dummy write starts erase
+    while(FCTL3 & BUSY);                // CPU held until done (from flash)
+    FCTL1 = FWKEY;                      // Clear erase mode
+    FCTL3 = FWKEY + LOCK;               // Lock
+    timers_resync();                    // Held longer than 10ms tick
+    ENABLE_INTERRUPTS;
+}
+
+void flash_write(const void *dest, const uint16_t *src, unsigned int count){
+    volatile uint16_t *d = (volatile uint16_t*)dest;
+    unsigned int i;
+
+    DISABLE_INTERRUPTS;
+    while(FCTL3 & BUSY);                // Wait for any previous operation
+    FCTL3 = FWKEY;                      // Unlock (leaves info A locked)
+    FCTL1 = FWKEY + WRT;                // Word write mode
+    for(i = 0; i < count; ++i){
+        d[i] = src[i];                  // CPU held until written (from flash)
+        while(FCTL3 & BUSY);
+    }
+    FCTL1 = FWKEY;                      // Clear write mode
+    FCTL3 = FWKEY + LOCK;               // Lock
+    timers_resync();                    // Long writes can pass a tick
+    ENABLE_INTERRUPTS;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file flashlog.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <flashlog.h>
+#include <flash.h>
+#include <history.h>
+#include <uca0uart.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define SEG_WORDS           (FLASH_MAIN_SEGMENT_SIZE / 2)   // Words per segment
+#define SAMPLE_WORDS        4                               // Words per sample
+#define RECORD_WORDS(n)     (1 + (n) * SAMPLE_WORDS + 1)    // Header + commit
+
+// Pointer to first word of a segment
+#define SEGMENT(i)          ((const uint16_t*)(uintptr_t)(FLASHLOG_START + (i) * FLASH_MAIN_SEGMENT_SIZE))
+
+#if FLASHLOG_DECIMATE > 256 || FLASHLOG_SEGMENTS > 255
+#error "flashlog: skip and segment counters are 8-bit"
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+unsigned int flashlog_tail;                 // Word offset of end of log in seg
+uint8_t flashlog_seg;                       // Segment being appended to
+uint8_t flashlog_skip;                      // Samples until next one is logged
+uint8_t flashlog_rec_count;                 // Samples in open record at tail
+
+// Dump state
+bool flashlog_dumping;
+uint8_t flashlog_dump_seg;                  // Segments dumped so far
+unsigned int flashlog_dump_pos;             // Word offset of current record
+unsigned int flashlog_dump_sample;          // Sample in current record
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Erase the next segment (oldest data) and start appending to it
+ */
+void flashlog_rotate(void){
+    uint16_t seq = SEGMENT(flashlog_seg)[0] + 1;
+    if(seq == FLASH_ERASED_WORD)
+        seq = 0;                            // Keep erased value distinguishable
+    flashlog_seg++;
+    if(flashlog_seg == FLASHLOG_SEGMENTS)
+        flashlog_seg = 0;
+    flash_erase(SEGMENT(flashlog_seg));
+    flash_write(SEGMENT(flashlog_seg), &seq, 1);
+    flashlog_tail = 1;
+}
+
+/**
+ * Find the word offset just past the last record in a segment
+ * @return Word offset or SEG_WORDS if the segment is unusable past the end
+ */
+unsigned int flashlog_scan(const uint16_t *seg){
+    unsigned int pos = 1;
+    while(pos < SEG_WORDS && seg[pos] != FLASH_ERASED_WORD){
+        if((seg[pos] & 0xFF00) != FLASHLOG_MAGIC)
+            return SEG_WORDS;               // Corrupt. Treat as full.
+        pos += RECORD_WORDS(seg[pos] & 0xFF);
+    }
+    if(pos > SEG_WORDS)
+        return SEG_WORDS;
+    return pos;
+}
+
+/**
+ * Index of oldest segment (the one after the newest)
+ */
+unsigned int flashlog_oldest(void){
+    unsigned int i = flashlog_seg + 1;
+    if(i == FLASHLOG_SEGMENTS)
+        i = 0;
+    return i;
+}
+
+void flashlog_init(void){
+    unsigned int i;
+    bool found = false;
+    uint16_t seq, newest = 0;
+
+    // Newest segment has the largest sequence number (allowing wrap)
+    for(i = 0; i < FLASHLOG_SEGMENTS; ++i){
+        seq = SEGMENT(i)[0];
+        if(seq == FLASH_ERASED_WORD)
+            continue;
+        if(!found || (int16_t)(seq - newest) > 0){
+            newest = seq;
+            flashlog_seg = i;
+            found = true;
+        }
+    }
+
+    if(found){
+        flashlog_tail = flashlog_scan(SEGMENT(flashlog_seg));
+    }else{
+        // Empty log. Start at the last segment so first rotate uses segment 0
+        flashlog_seg = FLASHLOG_SEGMENTS - 1;
+        flashlog_rotate();
+    }
+
+    flashlog_rec_count = 0;
+    flashlog_skip = 0;
+    flashlog_dumping = false;
+}
+
+/**
+ * Write the commit word of the open record (must be full) and close it
+ */
+void flashlog_commit(void){
+    uint16_t word = 0x0000;
+    flash_write(&SEGMENT(flashlog_seg)[flashlog_tail + RECORD_WORDS(FLASHLOG_BATCH) - 1], &word, 1);
+    flashlog_tail += RECORD_WORDS(FLASHLOG_BATCH);
+    flashlog_rec_count = 0;
+}
+
+void flashlog_add(uint32_t timestamp, int16_t temperature, unsigned int humidity, unsigned int status){
+    uint16_t s[SAMPLE_WORDS];
+
+    if(flashlog_skip != 0){
+        flashlog_skip--;
+        return;
+    }
+    flashlog_skip = FLASHLOG_DECIMATE - 1;
+
+    if(flashlog_rec_count == 0){
+        // Open a new record. Header is written first with the full sample
+        // count so the record's size is known even if it is never committed.
+        if(flashlog_tail + RECORD_WORDS(FLASHLOG_BATCH) > SEG_WORDS){
+            if(flashlog_dumping)
+                return;                     // Would erase what is dumped. Drop.
+            flashlog_rotate();
+        }
+        s[0] = FLASHLOG_MAGIC | FLASHLOG_BATCH;
+        flash_write(&SEGMENT(flashlog_seg)[flashlog_tail], s, 1);
+    }else if(flashlog_rec_count == FLASHLOG_BATCH){
+        return;                             // Commit held off by a dump. Drop.
+    }
+
+    s[0] = timestamp;
+    s[1] = timestamp >> 16;
+    s[2] = temperature;
+    s[3] = humidity | (status << 14);
+    flash_write(&SEGMENT(flashlog_seg)[flashlog_tail + 1 + flashlog_rec_count * SAMPLE_WORDS], s, SAMPLE_WORDS);
+    flashlog_rec_count++;
+
+    // Committing during a dump could change the count already sent
+    if(flashlog_rec_count == FLASHLOG_BATCH && !flashlog_dumping)
+        flashlog_commit();
+}
+
+/**
+ * Count samples in committed records of a segment
+ */
+unsigned int flashlog_seg_count(const uint16_t *seg){
+    unsigned int pos = 1, count = 0, n;
+    while(pos < SEG_WORDS && (seg[pos] & 0xFF00) == FLASHLOG_MAGIC){
+        n = seg[pos] & 0xFF;
+        if(pos + RECORD_WORDS(n) > SEG_WORDS)
+            break;
+        if(seg[pos + RECORD_WORDS(n) - 1] == 0x0000)
+            count += n;
+        pos += RECORD_WORDS(n);
+    }
+    return count;
+}
+
+void flashlog_dump_start(void){
+    uint8_t hdr[3];
+    unsigned int i, count = 0;
+
+    if(flashlog_dumping || uca0uart_write_avail() < sizeof(hdr))
+        return;
+
+    for(i = 0; i < FLASHLOG_SEGMENTS; ++i){
+        if(SEGMENT(i)[0] != FLASH_ERASED_WORD)
+            count += flashlog_seg_count(SEGMENT(i));
+    }
+
+    hdr[0] = 'F';
+    hdr[1] = count;
+    hdr[2] = count >> 8;
+    uca0uart_write_bytes(hdr, sizeof(hdr));
+
+    // Records are not committed and segments not erased during the dump, so
+    // the samples sent match the count
+    flashlog_dumping = true;
+    flashlog_dump_seg = 0;
+    flashlog_dump_pos = 1;
+    flashlog_dump_sample = 0;
+    flashlog_dump_next();
+}
+
+bool flashlog_dump_next(void){
+    const uint16_t *seg;
+    unsigned int i, n;
+
+    while(flashlog_dumping){
+        if(flashlog_dump_seg == FLASHLOG_SEGMENTS){
+            flashlog_dumping = false;
+            uca0uart_end_message();         // Last byte is arbitrary data
+            if(flashlog_rec_count == FLASHLOG_BATCH)
+                flashlog_commit();          // Held off during dump
+            break;
+        }
+
+        i = flashlog_oldest() + flashlog_dump_seg;
+        if(i >= FLASHLOG_SEGMENTS)
+            i -= FLASHLOG_SEGMENTS;
+        seg = SEGMENT(i);
+
+        // End of segment?
+        if(seg[0] == FLASH_ERASED_WORD || flashlog_dump_pos >= SEG_WORDS ||
+                (seg[flashlog_dump_pos] & 0xFF00) != FLASHLOG_MAGIC ||
+                flashlog_dump_pos + RECORD_WORDS(seg[flashlog_dump_pos] & 0xFF) > SEG_WORDS){
+            flashlog_dump_seg++;
+            flashlog_dump_pos = 1;
+            flashlog_dump_sample = 0;
+            continue;
+        }
+        n = seg[flashlog_dump_pos] & 0xFF;
+
+        // Skip uncommitted records and finished records
+        if(flashlog_dump_sample == n || seg[flashlog_dump_pos + RECORD_WORDS(n) - 1] != 0x0000){
+            flashlog_dump_pos += RECORD_WORDS(n);
+            flashlog_dump_sample = 0;
+            continue;
+        }
+
+        if(uca0uart_write_avail() < HISTORY_RECORD_BYTES)
+            break;                          // Continue on a later call
+
+        // Samples are stored in the same little endian layout as dumped
+        uca0uart_write_bytes((uint8_t*)&seg[flashlog_dump_pos + 1 + flashlog_dump_sample * SAMPLE_WORDS], HISTORY_RECORD_BYTES);
+        flashlog_dump_sample++;
+    }
+    return flashlog_dumping;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file fmt.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fmt.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Number of digits written for a magnitude (at least decimals + 1 so there is
+ * a digit before the point)
+ */
+unsigned int fmt_digits(uint32_t mag, unsigned int decimals){
+    unsigned int n;
+    if(mag <= 0xFFFF){
+        // Only 16-bit compares needed
+        if(mag >= 10000) n = 5;
+        else if(mag >= 1000) n = 4;
+        else if(mag >= 100) n = 3;
+        else if(mag >= 10) n = 2;
+        else n = 1;
+    }else{
+        if(mag >= 1000000000) n = 10;
+        else if(mag >= 100000000) n = 9;
+        else if(mag >= 10000000) n = 8;
+        else if(mag >= 1000000) n = 7;
+        else if(mag >= 100000) n = 6;
+        else n = 5;
+    }
+    return n > decimals ? n : decimals + 1;
+}
+
+/**
+ * Divide by 10 using shifts and adds (same method as udiv10, but kept here so
+ * the compiler can inline it for each digit). Uses 16-bit operations only once
+ * the value fits in 16 bits (see udiv10_16).
+ * @param n Value to divide (replaced by quotient)
+ * @return Remainder
+ */
+unsigned int fmt_div10(uint32_t *n){
+    uint32_t q, r;
+    uint16_t n16, q16, r16;
+    if(*n <= 0xFFFF){
+        n16 = *n;
+        q16 = (n16 >> 1) + (n16 >> 2);
+        q16 += q16 >> 4;
+        q16 += q16 >> 8;
+        q16 >>= 3;
+        r16 = n16 - ((q16 << 3) + (q16 << 1));
+        if(r16 >= 10){
+            q16++;
+            r16 -= 10;
+        }
+        *n = q16;
+        return r16;
+    }
+    q = (*n >> 1) + (*n >> 2);
+    q += q >> 4;
+    q += q >> 8;
+    q += q >> 16;
+    q >>= 3;
+    r = *n - ((q << 3) + (q << 1));
+    if(r >= 10){
+        q++;
+        r -= 10;
+    }
+    *n = q;
+    return r;
+}
+
+/**
+ * Store a char at a position spanning both regions
+ */
+void fmt_put(spsc_span spans[2], unsigned int pos, char c){
+    if(pos < spans[0].len)
+        spans[0].data[pos] = c;
+    else
+        spans[1].data[pos - spans[0].len] = c;
+}
+
+unsigned int fmt_fixed_len(int32_t value, unsigned int decimals, unsigned int width){
+    uint32_t mag = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    unsigned int len = fmt_digits(mag, decimals);
+    if(decimals != 0)
+        len++;                          // Point
+    if(value < 0)
+        len++;                          // Sign
+    return len < width ? width : len;
+}
+
+unsigned int fmt_fixed(int32_t value, unsigned int decimals, unsigned int width, spsc_span spans[2]){
+    uint32_t mag = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    unsigned int len, pos, ndig, i;
+    volatile uint8_t *p;
+
+    ndig = fmt_digits(mag, decimals);
+    len = ndig + (decimals != 0 ? 1 : 0) + (value < 0 ? 1 : 0);
+    if(len < width)
+        len = width;
+    if(len > spans[0].len + spans[1].len)
+        return 0;
+
+    if(len <= spans[0].len){
+        // Usual case. Fits in first region. Least significant digit first.
+        p = spans[0].data + len;
+        for(i = 0; i < ndig; ++i){
+            if(i == decimals && i != 0)
+                *--p = '.';
+            *--p = '0' + fmt_div10(&mag);
+        }
+        if(value < 0)
+            *--p = '-';
+        while(p != spans[0].data)
+            *--p = ' ';
+        return len;
+    }
+
+    // Wraps to second region
+    pos = len;
+    for(i = 0; i < ndig; ++i){
+        if(i == decimals && i != 0)
+            fmt_put(spans, --pos, '.');
+        fmt_put(spans, --pos, '0' + fmt_div10(&mag));
+    }
+    if(value < 0)
+        fmt_put(spans, --pos, '-');
+    while(pos > 0)
+        fmt_put(spans, --pos, ' ');
+    return len;
+}
+
+unsigned int fmt_fixed_str(int32_t value, unsigned int decimals, unsigned int width, char *buf){
+    spsc_span spans[2];
+    unsigned int len;
+    spans[0].data = (volatile uint8_t*)buf;
+    spans[0].len = (width > FMT_MAX_LEN ? width : FMT_MAX_LEN);
+    spans[1].data = spans[0].data;
+    spans[1].len = 0;
+    len = fmt_fixed(value, decimals, width, spans);
+    buf[len] = '\0';
+    return len;
+}
+
+unsigned int fmt_uint64_len(uint64_t value){
+    uint64_t p = 10;
+    unsigned int len = 1;
+    // Next power of 10 by shifts and adds (10^19 is the last that fits)
+    while(len < FMT_UINT64_MAX_LEN && value >= p){
+        p = (p << 3) + (p << 1);
+        len++;
+    }
+    return len;
+}
+
+unsigned int fmt_uint64(uint64_t value, spsc_span spans[2]){
+    uint16_t limb[4];                   // Most significant first
+    uint32_t n;
+    unsigned int i, r, top = 0, len, pos;
+
+    len = fmt_uint64_len(value);
+    if(len > spans[0].len + spans[1].len)
+        return 0;
+
+    // Long division by 10 over 16-bit limbs. Remainder is less than 10 so
+    // each step is one 32-bit division (no 64-bit division library call).
+    limb[0] = value >> 48;
+    limb[1] = value >> 32;
+    limb[2] = value >> 16;
+    limb[3] = value;
+    pos = len;
+    do{
+        r = 0;
+        for(i = top; i < 4; ++i){
+            n = ((uint32_t)r << 16) | limb[i];
+            r = fmt_div10(&n);
+            limb[i] = n;
+        }
+        fmt_put(spans, --pos, '0' + r);
+        while(top < 4 && limb[top] == 0)
+            top++;                      // Skip leading zero limbs
+    }while(top < 4);
+    return len;
+}
+
+unsigned int fmt_uint64_str(uint64_t value, char *buf){
+    spsc_span spans[2];
+    unsigned int len;
+    spans[0].data = (volatile uint8_t*)buf;
+    spans[0].len = FMT_UINT64_MAX_LEN;
+    spans[1].data = spans[0].data;
+    spans[1].len = 0;
+    len = fmt_uint64(value, spans);
+    buf[len] = '\0';
+    return len;
+}
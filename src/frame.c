@@ -0,0 +1,130 @@
+/**
+ * @file frame.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <frame.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t frame_seq = 0;
+
+// CRC-16/CCITT-FALSE remainder for each nibble (4 bits at a time keeps the
+// table small)
+const uint16_t frame_crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t *frame_put16(uint8_t *dest, uint16_t value){
+    dest[0] = value & 0xFF;
+    dest[1] = value >> 8;
+    return dest + 2;
+}
+
+/**
+ * Add one byte to a CRC-16/CCITT-FALSE
+ */
+uint16_t frame_crc_byte(uint16_t crc, uint8_t b){
+    crc ^= (uint16_t)b << 8;
+    crc = (crc << 4) ^ frame_crc_table[crc >> 12];
+    return (crc << 4) ^ frame_crc_table[crc >> 12];
+}
+
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, unsigned int len){
+    while(len--)
+        crc = frame_crc_byte(crc, *data++);
+    return crc;
+}
+
+/**
+ * Byte at a position spanning both regions
+ */
+volatile uint8_t *frame_at(spsc_span buf[2], unsigned int pos){
+    if(pos < buf[0].len)
+        return &buf[0].data[pos];
+    return &buf[1].data[pos - buf[0].len];
+}
+
+unsigned int frame_cobs(spsc_span buf[2], unsigned int len){
+    unsigned int i, code_pos, out;
+    uint8_t b, code;
+
+    // Each zero byte is replaced by the distance to the next zero (code byte
+    // written once known). out is always i + 1 so buf[i + 1] is read before
+    // it is written.
+    code_pos = 0;
+    out = 1;
+    code = 1;
+    for(i = 0; i < len; ++i){
+        b = *frame_at(buf, i + 1);
+        if(b == 0){
+            *frame_at(buf, code_pos) = code;
+            code_pos = out++;
+            code = 1;
+        }else{
+            *frame_at(buf, out++) = b;
+            code++;
+        }
+    }
+    *frame_at(buf, code_pos) = code;
+    *frame_at(buf, out++) = 0x00;       // Delimiter
+    return out;
+}
+
+unsigned int frame_encode(uint8_t type, uint64_t timestamp,
+        const uint8_t *payload, unsigned int len, spsc_span dest[2]){
+    uint32_t t = timestamp;
+    uint16_t crc = 0xFFFF;
+    unsigned int i, pos = 1;            // Unencoded frame at 1 (see frame_cobs)
+
+    // Written byte by byte so no frame sized buffer is needed
+    *frame_at(dest, pos++) = type;
+    *frame_at(dest, pos++) = frame_seq++;
+    for(i = 0; i < (type & FRAME_EPOCH ? 8 : 4); ++i){
+        if(i == 4)
+            t = timestamp >> 32;
+        *frame_at(dest, pos++) = t;
+        t >>= 8;
+    }
+    for(i = 0; i < len; ++i)
+        *frame_at(dest, pos++) = payload[i];
+    for(i = 1; i < pos; ++i)
+        crc = frame_crc_byte(crc, *frame_at(dest, i));
+    *frame_at(dest, pos++) = crc & 0xFF;
+    *frame_at(dest, pos++) = crc >> 8;
+
+    return frame_cobs(dest, pos - 1);
+}
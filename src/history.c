@@ -0,0 +1,246 @@
+/**
+ * @file history.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <history.h>
+#include <uca0uart.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define DUMP_HDR_BYTES      9               // Bytes in dump header
+#define MAX_SAMPLE_BYTES    9               // Max size of an encoded sample
+#define MAX_TS_DOD          0x3FFF          // Larger needs a new keyframe
+
+// Encoded sample forms (low two bits of first varint)
+#define FORM_LONG           0
+#define FORM_SHORT          1
+#define FORM_TINY           2
+
+// Zigzag encode a signed value so small magnitudes become small unsigned values
+#define ZIGZAG(x)           (((uint32_t)(x) << 1) ^ (uint32_t)((int32_t)(x) >> 31))
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+uint32_t history_seq;
+
+history_block history_blocks[HISTORY_BLOCKS];   // Ring of blocks
+uint8_t history_cur;                            // Block being appended to
+
+// Encoder state (previous sample in the current block)
+uint32_t history_last_ts;                       // Timestamp
+int32_t history_last_dt;                        // Timestamp delta
+int16_t history_last_temp;                      // Temperature
+uint16_t history_last_hum;                      // Humidity | status
+
+// Dump state
+unsigned int history_dump_lost;                 // Dropped (needed new block)
+bool history_dumping;                           // Dump in progress
+volatile bool history_dump_done;                // Set by uca0uart once sent
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Write an unsigned value as a varint
+ * @return Number of bytes written
+ */
+unsigned int history_varint(uint8_t *buf, uint32_t v){
+    unsigned int len = 0;
+    while(v >= 0x80){
+        buf[len++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    buf[len++] = v;
+    return len;
+}
+
+/**
+ * Start a new block with a keyframe (discards the oldest block if needed)
+ */
+void history_keyframe(history_block *blk, uint32_t ts, int16_t temp, uint16_t hum){
+    blk->data[0] = ts;
+    blk->data[1] = ts >> 8;
+    blk->data[2] = ts >> 16;
+    blk->data[3] = ts >> 24;
+    blk->data[4] = temp;
+    blk->data[5] = (uint16_t)temp >> 8;
+    blk->data[6] = hum;
+    blk->data[7] = hum >> 8;
+    blk->len = HISTORY_KEYFRAME_BYTES;
+    blk->count = 1;
+    history_last_dt = 0;
+}
+
+/**
+ * Encode a sample into the current block
+ */
+void history_encode(uint32_t ts, int16_t temp, uint16_t hum){
+    history_block *blk = &history_blocks[history_cur];
+    uint8_t buf[MAX_SAMPLE_BYTES];
+    unsigned int len, i;
+    int32_t dt, dod, dtemp, dhum;
+
+    if(blk->count == 0){
+        // Empty history. Start with a keyframe.
+        history_keyframe(blk, ts, temp, hum);
+    }else{
+        dt = ts - history_last_ts;
+        dod = dt - history_last_dt;
+        dtemp = (int32_t)temp - history_last_temp;
+        dhum = (int32_t)hum - history_last_hum;
+
+        len = 0;
+        if(dod > MAX_TS_DOD || dod < -MAX_TS_DOD){
+            // Timestamp jump too large to encode. Needs a new keyframe.
+        }else if(dtemp >= -1 && dtemp <= 1 && dhum >= -1 && dhum <= 1){
+            // Tiny form. Both deltas combined with timestamp.
+            len = history_varint(buf, ((ZIGZAG(dod) * 9 + (dtemp + 1) * 3 + (dhum + 1)) << 2) | FORM_TINY);
+        }else if(dtemp >= -8 && dtemp <= 7 && dhum >= -8 && dhum <= 7){
+            // Short form. Both deltas fit in a nibble.
+            len = history_varint(buf, (ZIGZAG(dod) << 2) | FORM_SHORT);
+            buf[len++] = ((dtemp + 8) << 4) | (dhum + 8);
+        }else{
+            len = history_varint(buf, (ZIGZAG(dod) << 2) | FORM_LONG);
+            len += history_varint(&buf[len], ZIGZAG(dtemp));
+            len += history_varint(&buf[len], ZIGZAG(dhum));
+        }
+
+        if(len != 0 && blk->len + len <= HISTORY_BLOCK_SIZE){
+            // Append to current block
+            for(i = 0; i < len; ++i)
+                blk->data[blk->len + i] = buf[i];
+            blk->len += len;
+            blk->count++;
+            history_last_dt = dt;
+        }else if(history_dumping){
+            // Would discard a block being sent. Drop.
+            history_dump_lost++;
+            return;
+        }else{
+            // Move to next block (discarding the oldest one)
+            history_cur++;
+            if(history_cur == HISTORY_BLOCKS)
+                history_cur = 0;
+            history_keyframe(&history_blocks[history_cur], ts, temp, hum);
+        }
+    }
+
+    history_last_ts = ts;
+    history_last_temp = temp;
+    history_last_hum = hum;
+    history_seq++;
+}
+
+void history_init(void){
+    unsigned int i;
+    for(i = 0; i < HISTORY_BLOCKS; ++i){
+        history_blocks[i].len = 0;
+        history_blocks[i].count = 0;
+    }
+    history_cur = 0;
+    history_seq = 0;
+    history_dump_lost = 0;
+    history_dumping = false;
+}
+
+void history_add(uint32_t timestamp, int16_t temperature, unsigned int humidity, unsigned int status){
+    // During a dump appending is safe: segments being sent end at the
+    // lengths the blocks had when the dump started.
+    history_encode(timestamp, temperature, humidity | (status << 14));
+}
+
+unsigned int history_count(void){
+    unsigned int i, count = 0;
+    for(i = 0; i < HISTORY_BLOCKS; ++i)
+        count += history_blocks[i].count;
+    return count;
+}
+
+unsigned int history_ratio(void){
+    unsigned int i;
+    uint32_t bytes = 0;
+    for(i = 0; i < HISTORY_BLOCKS; ++i)
+        bytes += history_blocks[i].len;
+    if(bytes == 0)
+        return 0;
+    return ((uint32_t)history_count() * HISTORY_RECORD_BYTES * 100) / bytes;
+}
+
+void history_dump_start(void){
+    uint8_t hdr[DUMP_HDR_BYTES];
+    uint32_t first;
+    unsigned int ratio, i, n;
+    history_block *blk;
+
+    if(history_dumping)
+        return;
+    if(uca0uart_write_avail() < DUMP_HDR_BYTES + HISTORY_BLOCKS ||
+            uca0uart_segment_avail() < HISTORY_BLOCKS)
+        return;                             // Host will have to ask again
+
+    first = history_seq - history_count();
+    ratio = history_ratio();
+    hdr[0] = 'H';
+    hdr[1] = history_count();
+    hdr[2] = first;
+    hdr[3] = first >> 8;
+    hdr[4] = first >> 16;
+    hdr[5] = first >> 24;
+    hdr[6] = ratio;
+    hdr[7] = ratio >> 8;
+    hdr[8] = HISTORY_BLOCKS;
+    uca0uart_write_bytes(hdr, DUMP_HDR_BYTES);
+
+    // Blocks are sent directly from RAM (oldest first; the one after the
+    // current block). They must not be discarded until the last one is sent.
+    history_dumping = true;
+    history_dump_done = false;
+    for(i = 0; i < HISTORY_BLOCKS; ++i){
+        n = history_cur + 1 + i;
+        if(n >= HISTORY_BLOCKS)
+            n -= HISTORY_BLOCKS;
+        blk = &history_blocks[n];
+        uca0uart_write_byte(blk->len);
+        uca0uart_write_segment(blk->data, blk->len,
+                i == HISTORY_BLOCKS - 1 ? &history_dump_done : NULL);
+    }
+    uca0uart_end_message();                 // Last byte is arbitrary data
+}
+
+bool history_dump_next(void){
+    if(history_dumping && history_dump_done)
+        history_dumping = false;        // Done. Blocks may be discarded again.
+    return history_dumping;
+}
@@ -40,6 +40,21 @@
 #include <aht10.h>
 #include <msp430helper.h>
 #include <uca0uart.h>
+#include <history.h>
+#include <flash.h>
+#include <flashlog.h>
+#include <derived.h>
+#include <stats.h>
+#include <filter.h>
+#include <change.h>
+#include <alarm.h>
+#include <adaptive.h>
+#include <calib.h>
+#include <frame.h>
+#include <fmt.h>
+#include <command.h>
+#include <node.h>
+#include <timesync.h>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +70,7 @@ volatile uint8_t flags = 0;
 #define TIMING_1S           BIT3        // Set every 1s
 #define AHT10_DONE          BIT4        // AHT10 I2C done (success or fail)
 #define AHT10_FAIL          BIT5        // AHT10 I2C failed
+#define UART_RX             BIT6        // Byte(s) received by uca0uart
 
 #define SET_FLAG(x)         flags |= (x)
 #define CHECK_FLAG(x)       (flags & x)
@@ -64,41 +80,748 @@ volatile uint8_t flags = 0;
 /// Program main tree
 ////////////////////////////////////////////////////////////////////////////////
 
+// Output modes
+#define OUTPUT_PERIODIC     0           // Print every sample each second
+#define OUTPUT_SUMMARY      1           // Print statistics once per window
+#define OUTPUT_CHANGE       2           // Print samples only when changed
+#define OUTPUT_NODE         3           // Only reply when polled (see node.h)
+
+#define SUMMARY_PART_MAX    19          // Max length of half a summary line
+#define REPORT_LINE_MAX     26          // Max length of a command response line
+
+// Longest start of a text sample: "T: -327.68\r\n" "H: 655.35\r\n". Each later
+// line ("DP: ", "AH: ", "HI: ") and the end ("TS: " line and blank line) can
+// be written after it.
+#define SAMPLE_FIRST_MAX    (12 + 7 + 6)
+#define SAMPLE_END_MAX      (6 + FMT_UINT64_MAX_LEN + 2)
+
+#if SAMPLE_FIRST_MAX > UCA0UART_WB_SIZE || SAMPLE_END_MAX > UCA0UART_WB_SIZE || \
+        SUMMARY_PART_MAX > UCA0UART_WB_SIZE || REPORT_LINE_MAX > UCA0UART_WB_SIZE
+#error "main: text line does not fit in the UART write buffer"
+#endif
+#if FRAME_MAX_SIZE > UCA0UART_WB_SIZE
+#error "main: frame does not fit in the UART write buffer"
+#endif
+
+// Send samples, summaries and alarms as binary frames (see frame.h) instead
+// of text at startup (can be changed at run time with 'B' and 'T' commands)
+#ifndef OUTPUT_BINARY_DEFAULT
+#define OUTPUT_BINARY_DEFAULT false
+#endif
+
+uint8_t output_mode = OUTPUT_PERIODIC;
+
+// Send output as binary frames instead of text
+bool output_binary = OUTPUT_BINARY_DEFAULT;
+
+// Include derived metrics (dew point, etc) in printed data
+bool print_derived = false;
+
+// Summary lines (of last stats window) waiting to be printed
+uint8_t summary_pending = 0;
+
+// Sample interval when not filtering or adaptive (in 100ms ticks; "$RATE")
+unsigned int sample_interval = 5;
+unsigned int sample_ticks = 0;          // Ticks since last sample
+
+// Alarm bits that changed but have not been sent yet
+uint8_t alarm_pending = 0;
+
+// On-demand query ('?' and '!' commands)
+bool sample_valid = false;              // At least one conversion completed
+bool query_pending = false;             // Reply when conversion completes
+
+// timers_now when the last byte was received (receipt time of 'Y')
+volatile uint32_t rx_time = 0;
+
+// Sampling report (since last 'R' command)
+uint32_t rate_start = 0;                // timers_now at start
+uint32_t rate_samples = 0;              // AHT10 conversions completed
+
+/**
+ * Print a value with two digits after the decimal point
+ * @param value Value to print (last two digits after decimal point)
+ */
+void print_number(int32_t value){
+    uca0uart_write_fixed(value, 2, 0);
+}
+
+/**
+ * Print a labeled value (on its own line)
+ * @param label Label to print before value
+ * @param value Value to print (last two digits after decimal point)
+ */
+void print_value(char *label, int32_t value){
+    uca0uart_write_str(label);
+    print_number(value);
+    uca0uart_write_str("\r\n");
+}
+
+/**
+ * Print a labeled value that is part of a sample
+ * @param whole true if space for the whole sample was reserved. Otherwise
+ *              waits for space for this line.
+ */
+void print_sample_value(char *label, int32_t value, bool whole){
+    if(!whole){
+        uca0uart_commit();
+        uca0uart_wait_avail(6 + fmt_fixed_len(value, 2, 0));
+    }
+    print_value(label, value);
+}
+
+/**
+ * Timestamp for a frame: host time once synchronized else time since boot
+ * @param type Frame type. FRAME_EPOCH is added if host time.
+ * @return Timestamp (see frame_encode)
+ */
+uint64_t frame_timestamp(uint8_t *type){
+    if(timesync_valid)
+        *type |= FRAME_EPOCH;
+    return timesync_time(timers_now);
+}
+
+/**
+ * Send a binary frame (dropped if not enough space in write buffer)
+ * @param type Frame type (see frame.h)
+ * @param payload Payload bytes
+ * @param len Number of payload bytes
+ */
+void send_frame(uint8_t type, uint8_t *payload, unsigned int len){
+    spsc_span spans[2];
+    uint64_t timestamp;
+    if(!uca0uart_reserve(FRAME_SIZE(len)))
+        return;
+    timestamp = frame_timestamp(&type);
+    // Encoded straight into the write buffer (no frame sized copy on the stack)
+    uca0uart_peek_write(spans);
+    uca0uart_commit_write(frame_encode(type, timestamp, payload, len, spans));
+}
+
+/**
+ * Send filtered sample as one FRAME_SAMPLE
+ * Payload: temperature, humidity [, dew point, abs humidity, heat index]
+ */
+void send_sample_frame(void){
+    uint8_t payload[10], *p;
+
+    p = frame_put16(payload, filter_temperature);
+    p = frame_put16(p, filter_humidity);
+    if(print_derived){
+        p = frame_put16(p, derived_dew_point(filter_temperature, filter_humidity));
+        p = frame_put16(p, derived_abs_humidity(filter_temperature, filter_humidity));
+        p = frame_put16(p, derived_heat_index(filter_temperature, filter_humidity));
+    }
+    send_frame(FRAME_SAMPLE, payload, p - payload);
+}
+
+/**
+ * Print filtered sample as text. Whole sample or nothing is sent.
+ */
+void print_sample_text(void){
+    int32_t dp = 0, ah = 0, hi = 0;
+    uint64_t t = 0;
+    unsigned int first, len, end;
+    bool whole;
+
+    if(print_derived){
+        dp = derived_dew_point(filter_temperature, filter_humidity);
+        ah = derived_abs_humidity(filter_temperature, filter_humidity);
+        hi = derived_heat_index(filter_temperature, filter_humidity);
+    }
+
+    // "T: " value "\r\n" "H: " value "\r\n" ["DP: " value "\r\n" ...]
+    // then end: ["TS: " host time "\r\n"] "\r\n"
+    first = 12 + fmt_fixed_len(filter_temperature, 2, 0) +
+            fmt_fixed_len(filter_humidity, 2, 0);
+    len = first;
+    if(print_derived)
+        len += 18 + fmt_fixed_len(dp, 2, 0) + fmt_fixed_len(ah, 2, 0) +
+                fmt_fixed_len(hi, 2, 0);
+    end = 2;
+    if(timesync_valid){
+        t = timesync_time(timers_now);
+        end += 6 + fmt_uint64_len(t);
+    }
+    // One reservation if the whole sample fits in the buffer. Otherwise the
+    // first lines are reserved and each later part is written once there is
+    // space for it so the sample is completed.
+    whole = len + end <= UCA0UART_WB_SIZE;
+    if(!uca0uart_reserve(whole ? len + end : first))
+        return;                         // Dropped (counted by uca0uart)
+    print_value("T: ", filter_temperature);
+    print_value("H: ", filter_humidity);
+    if(print_derived){
+        print_sample_value("DP: ", dp, whole);
+        print_sample_value("AH: ", ah, whole);
+        print_sample_value("HI: ", hi, whole);
+    }
+    if(!whole){
+        uca0uart_commit();
+        uca0uart_wait_avail(end);
+    }
+    if(timesync_valid){
+        uca0uart_write_str("TS: ");
+        uca0uart_write_uint64(t);
+        uca0uart_write_str("\r\n");
+    }
+    uca0uart_write_str("\r\n");
+    uca0uart_commit();
+}
+
+/**
+ * Print (or send frame of) filtered sample
+ * Separate functions so only one path's locals are on the stack
+ */
 void print_sensor_data(void){
-    char buf[13];
+    if(output_binary)
+        send_sample_frame();
+    else
+        print_sample_text();
+}
+
+/**
+ * Store a channel summary (min, max, mean, sd) in a frame payload
+ * @return Position after stored values
+ */
+uint8_t *put_stats(uint8_t *dest, stats_result *res){
+    dest = frame_put16(dest, res->min);
+    dest = frame_put16(dest, res->max);
+    dest = frame_put16(dest, res->mean);
+    return frame_put16(dest, res->sd);
+}
+
+/**
+ * Print next line of the last statistics summary (if any and space allows)
+ * Format: "ST: min max mean sd" (temperature) then "SH: ..." (humidity)
+ * Sent as one FRAME_SUMMARY instead when output_binary
+ */
+void print_summary_next(void){
+    stats_result *res;
+    uint8_t payload[16], *p;
+
+    if(summary_pending == 0)
+        return;
+
+    if(output_binary){
+        // Both channels in one frame: min, max, mean, sd for each
+        if(uca0uart_write_avail() < FRAME_SIZE(sizeof(payload)))
+            return;
+        p = put_stats(payload, &stats_last.temperature);
+        put_stats(p, &stats_last.humidity);
+        send_frame(FRAME_SUMMARY, payload, sizeof(payload));
+        summary_pending = 0;
+        return;
+    }
+
+    if(uca0uart_write_avail() < SUMMARY_PART_MAX)
+        return;
+
+    if(summary_pending == 2){
+        uca0uart_write_str("ST: ");
+        res = &stats_last.temperature;
+    }else{
+        uca0uart_write_str("SH: ");
+        res = &stats_last.humidity;
+    }
+    print_number(res->min);
+    uca0uart_write_byte(' ');
+    print_number(res->max);
+    uca0uart_wait_avail(SUMMARY_PART_MAX);  // Rest of the line once started
+    uca0uart_write_byte(' ');
+    print_number(res->mean);
+    uca0uart_write_byte(' ');
+    print_number(res->sd);
+    uca0uart_write_str(summary_pending == 2 ? "\r\n" : "\r\n\r\n");
+    summary_pending--;
+}
+
+/**
+ * Send pending alarm changes as one binary frame ahead of other output (after
+ * the frame being sent)
+ * Payload: alarm_state, changed bits, temperature, humidity
+ * Always has the short timestamp (time since boot) so that it fits in the
+ * priority buffer.
+ */
+void send_alarm_frame(void){
+    uint8_t payload[6], frame[FRAME_HEADER_SIZE + 6 + FRAME_CRC_SIZE + 2];
+    spsc_span spans[2] = {{frame, sizeof(frame)}, {frame, 0}};
     unsigned int len;
 
-    // Convert to string (last two digits after decimal point)
-    len = int_to_str(aht10_temperature, buf);
+    if(alarm_pending == 0)
+        return;
+    payload[0] = alarm_state;
+    payload[1] = alarm_pending;
+    frame_put16(&payload[2], aht10_temperature);
+    frame_put16(&payload[4], aht10_humidity);
+    len = frame_encode(FRAME_ALARM, timers_now, payload, sizeof(payload), spans);
+    if(uca0uart_write_priority(frame, len))
+        alarm_pending = 0;
+    else
+        frame_seq--;                    // Not sent. Reuse sequence number.
+}
 
-    // Shift last two digits (and null) right one place and add decimal
-    buf[len + 1] = buf[len];
-    buf[len] = buf[len - 1];
-    buf[len - 1] = buf[len - 2];
-    buf[len - 2] = '.';
+/**
+ * Send pending alarm changes ahead of other output
+ * Format: "!A TH 35.12\r\n" (raised) or "!C TH 34.40\r\n" (cleared)
+ * Channels: TH, TL (temperature high / low), HH, HL (humidity high / low)
+ * Sent as a binary frame instead when output_binary (see send_alarm_frame)
+ */
+void send_alarms(void){
+    static const char names[] = "THTLHHHL";
+    char frame[20], num[FMT_MAX_LEN + 1], *p;
+    unsigned int i, bit, len;
+
+    if(output_binary){
+        send_alarm_frame();
+        return;
+    }
+
+    for(i = 0, bit = ALARM_TEMP_HIGH; i < 4; ++i, bit <<= 1){
+        if(!(alarm_pending & bit))
+            continue;
+        frame[0] = '!';
+        frame[1] = (alarm_state & bit) ? 'A' : 'C';
+        frame[2] = ' ';
+        frame[3] = names[i * 2];
+        frame[4] = names[i * 2 + 1];
+        frame[5] = ' ';
+        fmt_fixed_str(i < 2 ? (int32_t)aht10_temperature : (int32_t)aht10_humidity, 2, 0, num);
+        for(len = 6, p = num; *p != '\0'; ++len, ++p)
+            frame[len] = *p;
+        frame[len++] = '\r';
+        frame[len++] = '\n';
+        if(!uca0uart_write_priority((uint8_t*)frame, len))
+            return;                     // No space. Retry later.
+        alarm_pending &= ~bit;
+    }
+}
 
-    // Print temperature
-    uca0uart_write_str("T: ");
+/**
+ * Print samples per hour and CPU active time since last called then restart
+ * Format: "SPH: n" then "ACT: percent"
+ * Text output only (would corrupt binary frames; see print_reply). Counting
+ * continues until a report is printed.
+ */
+void print_rate_report(void){
+    char buf[13];
+    uint32_t ms = timers_now - rate_start;
+    uint32_t total = ms;
+    uint32_t active = total - timers_sleep_ms;
+    uint32_t samples = rate_samples;
+    uint32_t sec = ms / 1000;
+    uint32_t sph = 0, act = 0;
+
+    if(output_binary)
+        return;
+
+    // Scale down so multiplies fit in 32 bits
+    while(samples > UINT32_MAX / 3600){
+        samples >>= 1;
+        sec >>= 1;
+    }
+    if(sec)
+        sph = (samples * 3600) / sec;
+
+    // Active percent (last two digits after decimal point)
+    if(total > timers_sleep_ms){
+        while(total > 400000){
+            total >>= 1;
+            active >>= 1;
+        }
+        act = (active * 10000) / total;
+    }
+
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    int_to_str(sph, buf);
+    uca0uart_write_str("SPH: ");
     uca0uart_write_str(&buf[1]);
     uca0uart_write_str("\r\n");
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    print_value("ACT: ", act);
+    uca0uart_write_str("\r\n");
 
-    // Convert to string (last two digits after decimal point)
-    len = int_to_str(aht10_humidity, buf);
-
-    // Shift last two digits (and null) right one place and add decimal
-    buf[len + 1] = buf[len];
-    buf[len] = buf[len - 1];
-    buf[len - 1] = buf[len - 2];
-    buf[len - 2] = '.';
+    rate_start = timers_now;
+    rate_samples = 0;
+    timers_sleep_ms = 0;
+    timers_sleep_ticks = 0;
+}
 
-    // Print temperature
-    uca0uart_write_str("H: ");
+/**
+ * Print an unsigned value followed by a separator
+ */
+void print_uint(unsigned int value, char *sep){
+    char buf[13];
+    uint16_to_str(value, buf);
     uca0uart_write_str(&buf[1]);
+    uca0uart_write_str(sep);
+}
+
+/**
+ * Print uca0uart drop counters and buffer high-water marks
+ * Format: "TXD: messages bytes" then "RXD: bytes" then "HWM: write priority read"
+ * Text output only (would corrupt binary frames; see print_reply)
+ */
+void print_uart_report(void){
+    if(output_binary)
+        return;
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("TXD: ");
+    print_uint(uca0uart_tx_drop_msgs, " ");
+    print_uint(uca0uart_tx_drop_bytes, "\r\n");
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("RXD: ");
+    print_uint(uca0uart_rx_drops, "\r\n");
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("HWM: ");
+    print_uint(uca0uart_wb_high, " ");
+    print_uint(uca0uart_pb_high, " ");
+    print_uint(uca0uart_rb_high, "\r\n\r\n");
+}
+
+/**
+ * Reply to a query with the last conversion (calibrated, before filtering)
+ * Format: "Q: age T H" (age of the conversion in ms; 10ms resolution)
+ * Sent as one FRAME_QUERY instead when output_binary
+ */
+void print_query(void){
+    uint8_t payload[6];
+    uint32_t age = timers_now - node_sample_time;
+
+    if(age > 0xFFFF)
+        age = 0xFFFF;                   // Saturate (frame field is 16 bits)
+
+    if(output_binary){
+        frame_put16(payload, age);
+        frame_put16(&payload[2], aht10_temperature);
+        frame_put16(&payload[4], aht10_humidity);
+        uca0uart_wait_avail(FRAME_SIZE(sizeof(payload)));
+        send_frame(FRAME_QUERY, payload, sizeof(payload));
+        return;
+    }
+
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("Q: ");
+    uca0uart_write_fixed(age, 0, 0);
+    uca0uart_write_byte(' ');
+    uca0uart_write_fixed(aht10_temperature, 2, 0);
+    uca0uart_write_byte(' ');
+    uca0uart_write_fixed(aht10_humidity, 2, 0);
+    uca0uart_write_str("\r\n");
+}
+
+/**
+ * Start a conversion and reply to a query when it completes
+ * Replies "Q: ERR" (text only) if the sensor has failed.
+ */
+void query_fresh(void){
+    if(aht10_ec != AHT10_EC_NONE){
+        if(!output_binary){
+            uca0uart_wait_avail(REPORT_LINE_MAX);
+            uca0uart_write_str("Q: ERR\r\n");
+        }
+        query_pending = false;
+        return;
+    }
+    query_pending = true;
+    aht10_read();                       // No effect if conversion in progress
+    sample_ticks = 0;                   // Next periodic read a full interval later
+}
+
+/**
+ * Handle a newly completed AHT10 sample
+ */
+void handle_sample(void){
+    rate_samples++;
+    node_sample();                      // Conversion time (also for queries)
+    sample_valid = true;
+    if(query_pending){
+        query_pending = false;
+        print_query();                  // Reply before any other processing
+    }
+    adaptive_update(timers_now, aht10_temperature, aht10_humidity);
+
+    // Alarms are checked on every conversion (before filtering)
+    alarm_pending |= alarm_check(aht10_temperature, aht10_humidity);
+    if(output_mode == OUTPUT_NODE)
+        alarm_pending = 0;              // Never unsolicited (NODE_REG_ALARM)
+    if(alarm_pending){
+        if(alarm_state)
+            RED_LED_ON;
+        send_alarms();
+    }
+
+    if(!filter_add(aht10_temperature, aht10_humidity))
+        return;                         // Decimated. Nothing to report.
+
+    history_add(timers_now, filter_temperature, filter_humidity, aht10_ec);
+    flashlog_add(timers_now, filter_temperature, filter_humidity, aht10_ec);
+    if(stats_add(timers_now, filter_temperature, filter_humidity) &&
+            output_mode == OUTPUT_SUMMARY)
+        summary_pending = 2;
+    if(output_mode == OUTPUT_CHANGE &&
+            change_check(timers_now, filter_temperature, filter_humidity))
+        print_sensor_data();
+}
+
+/**
+ * Print calibration. Format: "CT: offset gain" then "CH: offset gain"
+ * (offset in sample units, gain in Q15; both as received by 'K' command)
+ * Text output only (would corrupt binary frames; see print_reply)
+ */
+void print_calib(void){
+    char buf[13];
+    if(output_binary)
+        return;
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    int16_to_str(calib->temperature.offset, buf);
+    uca0uart_write_str("CT: ");
+    uca0uart_write_str(buf);
+    int16_to_str(calib->temperature.gain, buf);
+    uca0uart_write_byte(' ');
+    uca0uart_write_str(buf);
+    int16_to_str(calib->humidity.offset, buf);
+    uca0uart_write_str("\r\n");
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("CH: ");
+    uca0uart_write_str(buf);
+    int16_to_str(calib->humidity.gain, buf);
+    uca0uart_write_byte(' ');
+    uca0uart_write_str(buf);
     uca0uart_write_str("\r\n\r\n");
+}
+
+/**
+ * Reply to a time sync ('Y' command)
+ * Format: "Y: receipt error drift" (receipt is timers_now when the command
+ * was received in ms, error the host time minus the predicted time in ms and
+ * drift the clock correction in ppm; see timesync.h)
+ * Sent as one FRAME_SYNC instead when output_binary
+ * @param receipt timers_now when the command was received
+ */
+void print_sync(uint32_t receipt){
+    uint8_t payload[12];
+
+    if(output_binary){
+        frame_put16(payload, receipt & 0xFFFF);
+        frame_put16(&payload[2], receipt >> 16);
+        frame_put16(&payload[4], timesync_error & 0xFFFF);
+        frame_put16(&payload[6], (uint32_t)timesync_error >> 16);
+        frame_put16(&payload[8], timesync_drift & 0xFFFF);
+        frame_put16(&payload[10], (uint32_t)timesync_drift >> 16);
+        uca0uart_wait_avail(FRAME_SIZE(sizeof(payload)));
+        send_frame(FRAME_SYNC, payload, sizeof(payload));
+        return;
+    }
+
+    uca0uart_wait_avail(REPORT_LINE_MAX);
+    uca0uart_write_str("Y: ");
+    uca0uart_write_uint64(receipt);
+    uca0uart_write_byte(' ');
+    uca0uart_wait_avail(REPORT_LINE_MAX);   // Rest of the line
+    uca0uart_write_fixed(timesync_error, 0, 0);
+    uca0uart_write_byte(' ');
+    uca0uart_write_fixed(timesync_drift, 0, 0);
+    uca0uart_write_str("\r\n");
+}
+
+/**
+ * Reply to a line command (text output only; would corrupt binary frames)
+ */
+void print_reply(bool ok){
+    if(!output_binary)
+        uca0uart_write_str(ok ? "OK\r\n" : "ERR\r\n");
+}
+
+/**
+ * Select binary frames or text output
+ * @param binary true for binary frames (see frame.h), false for text
+ */
+void set_output_binary(bool binary){
+    output_binary = binary;
+    // Alarms (priority bytes) are sent only after a whole line or frame
+    uca0uart_set_message_end(binary ? 0x00 : '\n');
+    if(binary)
+        uca0uart_write_byte(0x00);      // End any partial text for decoder
+}
 
+/**
+ * Set sample interval for unfiltered, non-adaptive sampling
+ * @param ms Interval in ms (multiple of 100, 100 to 60000)
+ * @return true if valid
+ */
+bool set_sample_rate(int32_t ms){
+    if(ms < 100 || ms > 60000 || ms % 100 != 0)
+        return false;
+    sample_interval = ms / 100;
+    sample_ticks = 0;
+    return true;
+}
+
+/**
+ * Set a deadband for change reporting (change_temp_band / change_hum_band)
+ * @param band Deadband to set
+ * @param value New deadband (same units as samples, 0 to CHANGE_MAX_BAND)
+ * @return true if valid
+ */
+bool set_band(unsigned int *band, int32_t value){
+    if(value < 0 || value > CHANGE_MAX_BAND)
+        return false;
+    *band = value;
+    return true;
+}
+
+/**
+ * Store calibration from a 'K' command and print it
+ * Arguments: temperature offset, gain, humidity offset, gain (each 16-bit
+ * signed little endian)
+ */
+void set_calib(command *cmd){
+    calib_data data;
+    data.temperature.offset = cmd->args[0] | (cmd->args[1] << 8);
+    data.temperature.gain = cmd->args[2] | (cmd->args[3] << 8);
+    data.humidity.offset = cmd->args[4] | (cmd->args[5] << 8);
+    data.humidity.gain = cmd->args[6] | (cmd->args[7] << 8);
+    calib_store(&data);
+    print_calib();
+}
+
+/**
+ * Synchronize time from a 'Y' command and reply
+ * Argument: host time in ms since 1970 (64-bit little endian)
+ */
+void set_sync(command *cmd){
+    uint64_t host = 0;
+    uint32_t receipt;
+    unsigned int i;
+    for(i = COMMAND_ARGS_MAX; i > 0; --i)
+        host = (host << 8) | cmd->args[i - 1];
+    // The host waits for the reply before sending more, so the last byte
+    // received is the last byte of this command. Latched by the RX ISR so
+    // time spent before parsing (e.g. waiting for output space) does not add
+    // to it.
+    receipt = rx_time;
+    timesync_set(host, receipt);
+    print_sync(receipt);
+}
+
+/**
+ * Handle one command from the uca0uart command parser
+ * Commands with larger arguments use helpers so that their locals are only on
+ * the stack while handled.
+ */
+void handle_command(command *cmd){
+    switch(cmd->id){
+    case COMMAND_RATE:
+        print_reply(set_sample_rate(cmd->arg));
+        break;
+    case COMMAND_READ:
+        aht10_read();                   // Read now (next is a full interval)
+        sample_ticks = 0;
+        print_reply(true);
+        break;
+    case COMMAND_DUMP:
+        history_dump_start();
+        break;
+    case COMMAND_STATS:
+        summary_pending = 2;            // Print last window statistics
+        break;
+    case COMMAND_FORMAT:
+        set_output_binary(cmd->arg);
+        if(!output_binary)
+            print_reply(true);
+        break;
+    case COMMAND_NODE:
+        if(cmd->arg < 1 || cmd->arg > NODE_ID_MAX){
+            print_reply(false);
+            break;
+        }
+        print_reply(true);
+        node_store(cmd->arg);
+        output_mode = OUTPUT_NODE;      // Silent until polled
+        break;
+    case COMMAND_TBAND:
+        print_reply(set_band(&change_temp_band, cmd->arg));
+        break;
+    case COMMAND_HBAND:
+        print_reply(set_band(&change_hum_band, cmd->arg));
+        break;
+    case COMMAND_INVALID:
+        print_reply(false);
+        break;
+    case COMMAND_CALIB_SET:
+        set_calib(cmd);             // Store and print calibration
+        break;
+    case COMMAND_CALIB_GET:
+        print_calib();              // Print calibration
+        break;
+    case COMMAND_SYNC:
+        set_sync(cmd);              // Time sync
+        break;
+    case COMMAND_HISTORY:
+        history_dump_start();       // Dump sample history
+        break;
+    case COMMAND_FLASHLOG:
+        flashlog_dump_start();      // Dump sample log from flash
+        break;
+    case COMMAND_BINARY:
+        set_output_binary(true);    // Binary frames (see frame.h)
+        break;
+    case COMMAND_TEXT:
+        set_output_binary(false);   // Text output
+        break;
+    case COMMAND_DERIVED:
+        print_derived = !print_derived; // Toggle derived metrics output
+        break;
+    case COMMAND_PERIODIC:
+        output_mode = OUTPUT_PERIODIC;  // Print every sample
+        break;
+    case COMMAND_SUMMARY:
+        output_mode = OUTPUT_SUMMARY;   // Print window statistics only
+        break;
+    case COMMAND_CHANGE:
+        output_mode = OUTPUT_CHANGE;    // Print samples when changed
+        change_reset();                 // Next sample always printed
+        break;
+    case COMMAND_ADAPTIVE:
+        adaptive_enabled = !adaptive_enabled; // Toggle adaptive sampling
+        break;
+    case COMMAND_QUERY:
+        if(sample_valid && !query_pending)
+            print_query();              // Last conversion and its age
+        else
+            query_fresh();              // Nothing to report yet
+        break;
+    case COMMAND_QUERY_FRESH:
+        query_fresh();                  // Reply after a new conversion
+        break;
+    case COMMAND_RATE_REPORT:
+        print_rate_report();            // Samples/hour and CPU use
+        break;
+    case COMMAND_UART_REPORT:
+        print_uart_report();            // UART drops and buffer use
+        break;
+    case COMMAND_FILTER_NONE:
+        filter_set_type(FILTER_NONE);   // Report raw samples
+        break;
+    case COMMAND_FILTER_MA:
+        filter_set_type(FILTER_MA);     // Moving average
+        break;
+    case COMMAND_FILTER_EMA:
+        filter_set_type(FILTER_EMA);    // Exponential moving average
+        break;
+    case COMMAND_FILTER_MED3:
+        filter_set_type(FILTER_MEDIAN3); // 3 tap median
+        break;
+    case COMMAND_FILTER_MED5:
+        filter_set_type(FILTER_MEDIAN5); // 5 tap median
+        break;
+    }
 }
 
 int main(void){
+    command cmd;                        // Last command received
+
     // -------------------------------------------------------------------------
     // Initialization
     // -------------------------------------------------------------------------
@@ -111,6 +834,21 @@ int main(void){
     bbi2c_init();                       // Initialize SW I2C
     aht10_init();                       // Initialize AHT10 state machine
     uca0uart_init(uca0uart_BUAD_9600);  // Initialize uca0uart subsystem
+    set_output_binary(output_binary);   // Message end byte for alarms
+    history_init();                     // Initialize sample history
+    flash_init();                       // Initialize flash controller
+    calib_init();                       // Load sensor calibration
+    node_init();                        // Load RS-485 node ID
+    flashlog_init();                    // Find end of sample log in flash
+    stats_init();                       // Start first statistics window
+    filter_init();                      // No filter initially
+    change_init();                      // Default deadbands
+    alarm_init();                       // No alarms active
+    adaptive_init();                    // Adaptive sampling (disabled)
+    timesync_init();                    // Time since boot until host syncs
+    command_init();                     // Parse commands from uca0uart
+    if(node_id != 0)
+        output_mode = OUTPUT_NODE;      // Polled on RS-485 line
 
 
     // -------------------------------------------------------------------------
@@ -131,14 +869,25 @@ int main(void){
             // -----------------------------------------------------------------
             // Run every 10ms
             // -----------------------------------------------------------------
-            // Nothing here
+            history_dump_next();        // Finish history dump (if any)
+            send_alarms();              // Retry alarm messages (if any)
+            flashlog_dump_next();       // Continue flash log dump (if any)
+            print_summary_next();       // Print statistics summary (if any)
             // -----------------------------------------------------------------
         }else if(CHECK_FLAG(TIMING_100MS)){
             CLEAR_FLAG(TIMING_100MS);
             // -----------------------------------------------------------------
             // Run every 100ms
             // -----------------------------------------------------------------
-            // Nothing here
+            if(filter_type != FILTER_NONE)
+                aht10_read();           // Oversample AHT10 when filtering
+            else if(adaptive_enabled){
+                if(adaptive_tick())
+                    aht10_read();       // Adaptive sample rate
+            }else if(++sample_ticks >= sample_interval){
+                sample_ticks = 0;
+                aht10_read();           // Fixed sample rate (default 500ms)
+            }
             // -----------------------------------------------------------------
         }else if(CHECK_FLAG(TIMING_500MS)){
             CLEAR_FLAG(TIMING_500MS);
@@ -146,23 +895,42 @@ int main(void){
             // Run every 500ms
             // -----------------------------------------------------------------
             GRN_LED_TOGGLE;             // Blink green led with on-time 500ms
-            aht10_read();               // Attempt to read AHT10 every 500ms
             // -----------------------------------------------------------------
         }else if(CHECK_FLAG(TIMING_1S)){
             CLEAR_FLAG(TIMING_1S);
             // -----------------------------------------------------------------
             // Run every 1sec
             // -----------------------------------------------------------------
-            RED_LED_TOGGLE;             // Blink red led with on-time 1s
-            print_sensor_data();        // Print AHT10 data every second
+            timesync_update(timers_now); // Apply drift correction
+            if(alarm_state)
+                RED_LED_ON;             // Solid red led while alarm active
+            else
+                RED_LED_TOGGLE;         // Blink red led with on-time 1s
+            if(output_mode == OUTPUT_PERIODIC)
+                print_sensor_data();    // Print AHT10 data every second
             // -----------------------------------------------------------------
         }else if(CHECK_FLAG(AHT10_DONE)){
             CLEAR_FLAG(AHT10_DONE);
-            aht10_i2c_done(!CHECK_FLAG(AHT10_FAIL));
+            if(aht10_i2c_done(!CHECK_FLAG(AHT10_FAIL)))
+                handle_sample();        // New sample completed
+            else if(query_pending && aht10_ec != AHT10_EC_NONE)
+                query_fresh();          // Sensor failed. Reply with error.
             CLEAR_FLAG(AHT10_FAIL);
+        }else if(CHECK_FLAG(UART_RX)){
+            CLEAR_FLAG(UART_RX);
+            if(output_mode == OUTPUT_NODE){
+                node_poll();            // Reply if addressed
+                if(node_id == 0){
+                    output_mode = OUTPUT_PERIODIC; // Left polled mode
+                    command_init();
+                }
+            }else if(command_next(&cmd)){
+                handle_command(&cmd);
+                SET_FLAG(UART_RX);      // Maybe more. Other flags first.
+            }
         }else{
             // No flags set. Enter LPM0. Interrupts will exit LPM0 when flag set
-            LPM0;
+            timers_sleep();
         }
     }
 }
@@ -182,10 +950,11 @@ __interrupt void isr_timera0_ccr0(void){
     TA0CCTL0 &= ~CCIE;                  // Disable interrupt
     unsigned int res = bbi2c_next();    // Move to next state
 
-    if(res == BBI2C_DONE && bbi2c_trans == &aht10_trans){
+    // Transactions for the AHT10 (the only device on the bus so far)
+    if(res == BBI2C_DONE && bbi2c_trans->address == AHT10_ADDR){
         SET_FLAG(AHT10_DONE);
         LPM0_EXIT;
-    }else if(res == BBI2C_FAIL && bbi2c_trans == &aht10_trans){
+    }else if(res == BBI2C_FAIL && bbi2c_trans->address == AHT10_ADDR){
         SET_FLAG(AHT10_DONE | AHT10_FAIL);
         LPM0_EXIT;
     }
@@ -196,7 +965,10 @@ __interrupt void isr_timera0_ccrn(void){
     switch(__even_in_range(TA0IV, TAIV__TAIFG)){
        case TAIV__NONE:                 // No interrupt
            break;
-       case TAIV__TACCR1:               // CCR1: Unused
+       case TAIV__TACCR1:               // CCR1: RS-485 transmit enable
+           TA0CCTL1 &= ~CCIE;           // Disable interrupt
+           if(!uca0uart_handle_txen())
+               timers_txen_delay();     // Still sending. Check again later.
            break;
        case TAIV__TACCR2:               // CCR2: Unused
            break;
@@ -253,7 +1025,10 @@ __interrupt void isr_timera1_ccrn(void){
 __interrupt void usci0_rx_isr(void){
     if(IFG2 & UCA0RXIFG){
         IFG2 &= ~UCA0RXIFG;             // Clear RX flag for UCA0
+        rx_time = timers_now;           // Receipt time of last byte
         uca0uart_handle_read();         // Handle uca0uart receive
+        SET_FLAG(UART_RX);              // Set correct flag
+        LPM0_EXIT;                      // Flag needs handling; exit LPM0
     }
 }
 
@@ -261,7 +1036,10 @@ __interrupt void usci0_rx_isr(void){
 __interrupt void usci0_tx_isr(void){
     if(IFG2 & UCA0TXIFG){
         IFG2 &= ~UCA0TXIFG;             // Clear TX flag for UCA0
-        uca0uart_handle_write();        // Handle uca0uart transmit
+        if(uca0uart_handle_write())     // Handle uca0uart transmit
+            LPM0_EXIT;                  // Space for uca0uart_wait_avail
+        if(!(IE2 & UCA0TXIE))
+            timers_txen_delay();        // Last byte. Release RS-485 when sent.
     }
 }
 
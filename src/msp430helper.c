@@ -73,6 +73,38 @@ unsigned int int_to_str(int32_t value, char *data){
     return numdig + 1;
 }
 
+unsigned int uint16_to_str(uint16_t value, char *data){
+    // Max unsigned 16-bit int is 65535 = 5 digits + 1 for sign = 6 chars + 1 for null
+    data[0] = '+';
+
+    // Determine how many digits in the given value
+    unsigned int numdig;
+    if(value >= 10000) numdig = 5;
+    else if(value >= 1000) numdig = 4;
+    else if(value >= 100) numdig = 3;
+    else if(value >= 10) numdig = 2;
+    else numdig = 1;
+
+    // Get ascii value of each digit & store in string
+    unsigned int i;
+    uint16_t q, r;
+    for(i = 0; i < numdig; ++i){
+        udiv10_16(value, &q, &r);
+        value = q;
+        data[numdig - i] = '0' + r;
+    }
+    data[numdig + 1] = '\0';
+    return numdig + 1;
+}
+
+unsigned int int16_to_str(int16_t value, char *data){
+    // Magnitude of -32768 only fits unsigned (negate as unsigned)
+    unsigned int len = uint16_to_str(value < 0 ? (uint16_t)(0u - (uint16_t)value) : (uint16_t)value, data);
+    if(value < 0)
+        data[0] = '-';
+    return len;
+}
+
 void udiv10(uint32_t n, uint32_t *q, uint32_t *r) {
     *q = (n >> 1) + (n >> 2);
     *q = *q + (*q >> 4);
@@ -84,3 +116,15 @@ void udiv10(uint32_t n, uint32_t *q, uint32_t *r) {
     if(*r >= 10) *r -= 10;
 }
 
+
+void udiv10_16(uint16_t n, uint16_t *q, uint16_t *r) {
+    *q = (n >> 1) + (n >> 2);
+    *q = *q + (*q >> 4);
+    *q = *q + (*q >> 8);
+    *q = *q >> 3;
+    *r = n - ((*q << 3) + (*q << 1));
+    if(*r >= 10){
+        *q = *q + 1;
+        *r -= 10;
+    }
+}
@@ -0,0 +1,230 @@
+/**
+ * @file node.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <node.h>
+#include <flash.h>
+#include <frame.h>
+#include <uca0uart.h>
+#include <timers.h>
+#include <aht10.h>
+#include <alarm.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define NODE_WORDS          3           // Magic, ID, checksum
+
+// Stored node ID in info flash
+#ifndef NODE_FLASH
+#define NODE_FLASH          ((const uint16_t*)(uintptr_t)NODE_ADDR)
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t node_id = 0;
+
+uint32_t node_sample_time = 0;          // timers_now of last conversion
+uint16_t node_sample_count = 0;         // Conversions completed
+
+// COBS decoder state
+uint8_t node_buf[NODE_REQUEST_MAX];     // Decoded request
+uint8_t node_len = 0;                   // Bytes in node_buf
+uint8_t node_code = 0;                  // Bytes left in block (0: code next)
+bool node_zero = false;                 // Zero before next block
+bool node_bad = false;                  // Too long. Ignore until delimiter.
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+void node_init(void){
+    const uint16_t *f = NODE_FLASH;
+    if(f[0] == NODE_MAGIC && (uint16_t)(f[0] + f[1] + f[2]) == 0 &&
+            f[1] <= NODE_ID_MAX)
+        node_id = f[1];
+    else
+        node_id = 0;                    // Missing or corrupt. Not polled.
+}
+
+void node_store(uint8_t id){
+    uint16_t words[NODE_WORDS];
+
+    node_id = id;
+
+    words[0] = NODE_MAGIC;
+    words[1] = id;
+    words[2] = -(words[0] + words[1]);  // Sum of all words is 0
+
+    flash_erase(NODE_FLASH);
+    flash_write(NODE_FLASH, words, NODE_WORDS);
+}
+
+void node_sample(void){
+    node_sample_time = timers_now;
+    node_sample_count++;
+}
+
+/**
+ * Read a register
+ */
+uint16_t node_reg(unsigned int reg){
+    uint32_t age;
+    switch(reg){
+    case NODE_REG_TEMP:
+        return aht10_temperature;
+    case NODE_REG_HUM:
+        return aht10_humidity;
+    case NODE_REG_AGE:
+        age = timers_now - node_sample_time;
+        return age > 0xFFFF ? 0xFFFF : age;
+    case NODE_REG_STATUS:
+        return aht10_ec;
+    case NODE_REG_ALARM:
+        return alarm_state;
+    case NODE_REG_COUNT:
+        return node_sample_count;
+    default:
+        return node_id;
+    }
+}
+
+/**
+ * Handle a decoded request in node_buf (without CRC)
+ * Builds reply at reply[1] (see frame_cobs)
+ * @return Reply length (unencoded, without CRC)
+ */
+unsigned int node_request(unsigned int len, uint8_t *reply){
+    uint8_t *r = &reply[1];
+    uint8_t fn = node_buf[1];
+    unsigned int i, count, reg = node_buf[2];
+    uint16_t value;
+
+    r[0] = node_id | NODE_REPLY;
+    r[1] = fn;
+    if(fn == NODE_FN_READ && len == 4){
+        count = node_buf[3];
+        if(count == 0 || reg >= NODE_REGS || count > NODE_REGS - reg){
+            r[2] = NODE_ERR_ADDRESS;
+        }else{
+            r[2] = count;
+            for(i = 0; i < count; ++i)
+                frame_put16(&r[3 + 2 * i], node_reg(reg + i));
+            return 3 + 2 * count;
+        }
+    }else if(fn == NODE_FN_WRITE && len == 5){
+        value = node_buf[3] | (node_buf[4] << 8);
+        if(reg != NODE_REG_ID){
+            r[2] = NODE_ERR_ADDRESS;
+        }else if(value > NODE_ID_MAX || (node_buf[0] == NODE_BROADCAST && value != 0)){
+            r[2] = NODE_ERR_VALUE;      // IDs must be unique. No broadcast.
+        }else{
+            node_store(value);
+            r[2] = reg;
+            frame_put16(&r[3], value);
+            return 5;
+        }
+    }else{
+        r[2] = NODE_ERR_FUNCTION;
+    }
+    r[1] |= NODE_FN_ERROR;
+    return 3;
+}
+
+/**
+ * Check and handle a complete decoded request in node_buf
+ */
+void node_frame(void){
+    uint8_t reply[NODE_REPLY_MAX + 2];
+    spsc_span spans[2] = {{reply, sizeof(reply)}, {reply, 0}};
+    unsigned int len;
+
+    if(node_len < 2 + 2 || (node_buf[0] != node_id && node_buf[0] != NODE_BROADCAST))
+        return;                         // Not for this node (or a reply)
+    len = node_len - 2;
+    if(frame_crc16(0xFFFF, node_buf, len) != (node_buf[len] | (node_buf[len + 1] << 8)))
+        return;                         // Corrupt
+
+    len = node_request(len, reply);
+    if(node_buf[0] == NODE_BROADCAST)
+        return;                         // Never answered
+    frame_put16(&reply[1 + len], frame_crc16(0xFFFF, &reply[1], len));
+    len = frame_cobs(spans, len + 2);
+    if(!uca0uart_reserve(len))
+        return;                         // Dropped (counted by uca0uart)
+    uca0uart_write_bytes(reply, len);
+    uca0uart_commit();
+}
+
+/**
+ * Add a decoded byte to node_buf
+ */
+void node_put(uint8_t b){
+    if(node_len == NODE_REQUEST_MAX)
+        node_bad = true;                // Too long for a request
+    else
+        node_buf[node_len++] = b;
+}
+
+void node_feed(uint8_t b){
+    if(b == 0){
+        // Delimiter. Complete only if the last block ended here.
+        if(!node_bad && node_code == 0)
+            node_frame();
+        node_len = 0;
+        node_code = 0;
+        node_zero = false;
+        node_bad = false;
+        return;
+    }
+    if(node_bad)
+        return;
+    if(node_code == 0){
+        // Code byte: b - 1 data bytes follow. Unless the last block was full
+        // (code 0xFF) a zero came before this block.
+        if(node_zero)
+            node_put(0);
+        node_zero = b != 0xFF;
+        node_code = b - 1;
+        return;
+    }
+    node_put(b);
+    node_code--;
+}
+
+void node_poll(void){
+    uint8_t b;
+    while(uca0uart_read_byte(&b))
+        node_feed(b);
+}
@@ -59,6 +59,12 @@ void ports_init1(void){
     P1SEL |= UCA0TXD;       // UCA0 function
     P1SEL2 |= UCA0TXD;      // UCA0 function
 
+    P1SEL &= ~RS485_TXEN;   // GPIO function
+    P1SEL2 &= ~RS485_TXEN;  // GPIO function
+    P1DIR |= RS485_TXEN;    // Output direction
+    P1IE &= ~RS485_TXEN;    // Disable interrupt
+    P1OUT &= ~RS485_TXEN;   // Initially low (receive)
+
     P1SEL &= ~RED_LED;      // GPIO function
     P1SEL2 &= ~RED_LED;     // GPIO function
     P1DIR |= RED_LED;       // Output direction
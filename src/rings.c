@@ -1,5 +1,7 @@
 /**
- * @file circular_buffer.c
+ * @file rings.c
+ * @brief Functions for typed rings (see ring.h)
+ * Kept apart from code using the rings so commit and release are real calls.
  * @author Marcus Behel (mgbehel@ncsu.edu)
  */
 
@@ -27,39 +29,12 @@
  * SOFTWARE.
  */
 
-#include <circular_buffer.h>
+#include <ring.h>
+#include <uca0uart.h>
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Functions
 ////////////////////////////////////////////////////////////////////////////////
 
-void cb_init(volatile circular_buffer *cb, volatile uint8_t *backing_array, unsigned int len){
-    cb->array = backing_array;
-    cb->size = len;
-    cb->count = 0;
-    cb->write_pos = 0;
-    cb->read_pos = 0;
-}
-
-bool cb_write(volatile circular_buffer *cb, uint8_t src){
-    if(CB_FULL(cb))
-        return false;
-    cb->array[cb->write_pos] = src;
-    cb->count++;
-    cb->write_pos++;
-    if(cb->write_pos == cb->size)
-        cb->write_pos = 0;
-    return true;
-}
-
-bool cb_read(volatile circular_buffer *cb, uint8_t *dest){
-    if(CB_EMPTY(cb))
-        return false;
-    *dest = cb->array[cb->read_pos];
-    cb->count--;
-    cb->read_pos++;
-    if(cb->read_pos == cb->size)
-        cb->read_pos = 0;
-    return true;
-}
+RING_DEFINE(uca0uart_segment_ring, uca0uart_segment, UCA0UART_SEGMENTS)
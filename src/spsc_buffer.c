@@ -0,0 +1,138 @@
+/**
+ * @file spsc_buffer.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <spsc_buffer.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+void spsc_init(volatile spsc_buffer *sb, volatile uint8_t *backing_array, unsigned int len){
+    sb->array = backing_array;
+    sb->mask = len - 1;
+    sb->head = 0;
+    sb->tail = 0;
+}
+
+bool spsc_write(volatile spsc_buffer *sb, uint8_t src){
+    unsigned int head = sb->head;
+    if(head - sb->tail > sb->mask)
+        return false;
+    sb->array[head & sb->mask] = src;
+    sb->head = head + 1;        // Publish after data is written
+    return true;
+}
+
+bool spsc_read(volatile spsc_buffer *sb, uint8_t *dest){
+    unsigned int tail = sb->tail;
+    if(tail == sb->head)
+        return false;
+    *dest = sb->array[tail & sb->mask];
+    sb->tail = tail + 1;        // Release after data is read
+    return true;
+}
+
+/**
+ * Split count bytes starting at index into regions before and after the end of
+ * the backing array
+ */
+void spsc_spans(volatile spsc_buffer *sb, unsigned int index, unsigned int count, spsc_span spans[2]){
+    unsigned int pos = index & sb->mask;
+    unsigned int to_end = sb->mask + 1 - pos;
+    spans[0].data = &sb->array[pos];
+    if(count <= to_end){
+        spans[0].len = count;
+        spans[1].len = 0;
+    }else{
+        spans[0].len = to_end;
+        spans[1].len = count - to_end;
+    }
+    spans[1].data = sb->array;
+}
+
+unsigned int spsc_peek_write(volatile spsc_buffer *sb, spsc_span spans[2]){
+    unsigned int head = sb->head;
+    unsigned int avail = sb->mask + 1 - (head - sb->tail);
+    spsc_spans(sb, head, avail, spans);
+    return avail;
+}
+
+void spsc_commit_write(volatile spsc_buffer *sb, unsigned int len){
+    sb->head += len;            // Only producer writes head
+}
+
+unsigned int spsc_peek_read(volatile spsc_buffer *sb, spsc_span spans[2]){
+    unsigned int tail = sb->tail;
+    unsigned int avail = sb->head - tail;
+    spsc_spans(sb, tail, avail, spans);
+    return avail;
+}
+
+void spsc_commit_read(volatile spsc_buffer *sb, unsigned int len){
+    sb->tail += len;            // Only consumer writes tail
+}
+
+unsigned int spsc_write_block(volatile spsc_buffer *sb, const uint8_t *src, unsigned int len){
+    spsc_span spans[2];
+    unsigned int i, j, n;
+
+    n = spsc_peek_write(sb, spans);
+    if(len > n)
+        len = n;
+    n = len;
+    for(i = 0; i < 2 && n > 0; ++i){
+        if(spans[i].len > n)
+            spans[i].len = n;
+        for(j = 0; j < spans[i].len; ++j)
+            spans[i].data[j] = *src++;
+        n -= spans[i].len;
+    }
+    spsc_commit_write(sb, len);
+    return len;
+}
+
+unsigned int spsc_read_block(volatile spsc_buffer *sb, uint8_t *dest, unsigned int len){
+    spsc_span spans[2];
+    unsigned int i, j, n;
+
+    n = spsc_peek_read(sb, spans);
+    if(len > n)
+        len = n;
+    n = len;
+    for(i = 0; i < 2 && n > 0; ++i){
+        if(spans[i].len > n)
+            spans[i].len = n;
+        for(j = 0; j < spans[i].len; ++j)
+            *dest++ = spans[i].data[j];
+        n -= spans[i].len;
+    }
+    spsc_commit_read(sb, len);
+    return len;
+}
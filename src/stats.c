@@ -0,0 +1,152 @@
+/**
+ * @file stats.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stats.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+stats_summary stats_last;
+
+stats_acc stats_temp;                       // Temperature accumulator
+stats_acc stats_hum;                        // Humidity accumulator
+unsigned int stats_count;                   // Samples in current window
+uint32_t stats_start;                       // Timestamp window started
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Integer square root
+ */
+uint16_t stats_sqrt(uint32_t x){
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while(bit > x)
+        bit >>= 2;
+    while(bit != 0){
+        if(x >= res + bit){
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        }else{
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+/**
+ * Add a value to an accumulator
+ * n is the number of values including this one
+ */
+void stats_acc_add(stats_acc *acc, int16_t x, unsigned int n){
+    int32_t d;
+
+    if(n == 1){
+        acc->min = x;
+        acc->max = x;
+        acc->first = x;
+        acc->sum = 0;
+        acc->sum_sq = 0;
+        return;
+    }
+
+    if(x < acc->min)
+        acc->min = x;
+    if(x > acc->max)
+        acc->max = x;
+
+    d = (int32_t)x - acc->first;
+    acc->sum += d;
+    acc->sum_sq += (uint32_t)d * (uint32_t)d;   // |d| < 2^16 so exact
+}
+
+/**
+ * Divide by a 16-bit value using long division over 16-bit limbs (each step
+ * is a 32-bit division; no 64-bit division library call)
+ */
+uint64_t stats_div(uint64_t x, unsigned int d){
+    uint64_t q = 0;
+    uint32_t r = 0, cur;
+    int i;
+    for(i = 48; i >= 0; i -= 16){
+        cur = (r << 16) | (uint16_t)(x >> i);
+        q = (q << 16) | (cur / d);
+        r = cur % d;
+    }
+    return q;
+}
+
+/**
+ * Produce result from an accumulator
+ */
+void stats_acc_result(stats_acc *acc, stats_result *res, unsigned int n){
+    uint32_t mag = acc->sum < 0 ? -(uint32_t)acc->sum : (uint32_t)acc->sum;
+    int32_t mean;
+
+    res->min = acc->min;
+    res->max = acc->max;
+
+    // Mean rounded to nearest (half away from zero)
+    mean = (mag + n / 2) / n;
+    res->mean = acc->first + (acc->sum < 0 ? -mean : mean);
+
+    // Sample variance = (n * sum_sq - sum^2) / n / (n - 1). Fits 32 bits.
+    res->sd = (n > 1) ? stats_sqrt(stats_div(stats_div(
+            acc->sum_sq * n - (uint64_t)mag * mag, n), n - 1)) : 0;
+}
+
+void stats_init(void){
+    stats_count = 0;
+    stats_last.count = 0;
+}
+
+bool stats_add(uint32_t timestamp, int16_t temperature, unsigned int humidity){
+    bool done = false;
+
+    if(stats_count != 0 && timestamp - stats_start >= STATS_WINDOW_MS){
+        // Sample is past end of window. Summarize window then start new one.
+        stats_last.count = stats_count;
+        stats_acc_result(&stats_temp, &stats_last.temperature, stats_count);
+        stats_acc_result(&stats_hum, &stats_last.humidity, stats_count);
+        stats_count = 0;
+        done = true;
+    }
+
+    if(stats_count == 0)
+        stats_start = timestamp;
+    stats_count++;
+    stats_acc_add(&stats_temp, temperature, stats_count);
+    stats_acc_add(&stats_hum, humidity, stats_count);
+    return done;
+}
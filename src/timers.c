@@ -37,7 +37,9 @@
 /// Globals
 ////////////////////////////////////////////////////////////////////////////////
 volatile uint32_t timers_now = 0;
-volatile unsigned int timers_500_count = 0;
+volatile uint8_t timers_500_count = 0;
+volatile uint32_t timers_sleep_ms = 0;
+volatile unsigned int timers_sleep_ticks = 0;
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,9 +56,9 @@ void timers_init_a0(void){
     TA0CCTL0 &= ~CCIFG;             // Clear CCR0 IFG
     TA0CCTL0 &= ~CCIE;              // Disable CCR0 interrupt (for now)
 
-    // Unused
+    // Used for RS-485 transmit enable
     TA0CCTL1 &= ~CCIFG;             // Clear CCR1 IFG
-    TA0CCTL1 &= ~CCIE;              // Disable CCR1 interrupt
+    TA0CCTL1 &= ~CCIE;              // Disable CCR1 interrupt (for now)
 
     // Unused
     TA0CCTL2 &= ~CCIFG;             // Clear CCR2 IFG
@@ -96,6 +98,29 @@ void timers_init(void){
     timers_init_a1();
 }
 
+void timers_sleep(void){
+    // TA1 counts at 125kHz. Never asleep longer than 10ms (TA1 CCR0) so
+    // 16-bit difference does not wrap.
+    uint16_t start = TA1R;
+    LPM0;
+    timers_sleep_ticks += (uint16_t)(TA1R - start);
+
+    // Carry whole ms. At most 10 passes (10ms).
+    while(timers_sleep_ticks >= TA1_TICKS_PER_MS){
+        timers_sleep_ticks -= TA1_TICKS_PER_MS;
+        timers_sleep_ms++;
+    }
+}
+
+void timers_resync(void){
+    // Pending CCR0 interrupt adds one more period. Missed periods if that
+    // would still be at or behind TA1R.
+    while((int16_t)(TA1R - TA1CCR0) >= TA1CCR0_OFFSET - TA1_RESYNC_MARGIN){
+        TA1CCR0 += TA1CCR0_OFFSET;
+        timers_now += 10;
+    }
+}
+
 void timers_bbi2c_delay(void){
     // TA0 counts at 1MHz = TimerFreq (see timer steup above)
     // I2CDataRate (up to 100kHz is normal mode)
@@ -107,3 +132,9 @@ void timers_bbi2c_delay(void){
     TA0CCR0 = TA0R + period;        // Set time of next interrupt
     TACCTL0 |= CCIE;                // Enable interrupt
 }
+
+void timers_txen_delay(void){
+    TA0CCTL1 &= ~CCIFG;             // Clear CCR1 IFG
+    TA0CCR1 = TA0R + TA0CCR1_OFFSET;// Set time of next interrupt
+    TA0CCTL1 |= CCIE;               // Enable interrupt
+}
@@ -0,0 +1,143 @@
+/**
+ * @file timesync.c
+ * @author Marcus Behel (mgbehel@ncsu.edu)
+ */
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Marcus Behel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <timesync.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Globals
+////////////////////////////////////////////////////////////////////////////////
+
+bool timesync_valid;
+int32_t timesync_drift;
+int32_t timesync_error;
+
+uint64_t timesync_base;                     // Corrected time at timesync_last
+uint32_t timesync_last;                     // timers_now of reference point
+int32_t timesync_frac;                      // Correction not yet applied (ns)
+uint32_t timesync_anchor;                   // timers_now drift interval start
+int32_t timesync_acc;                       // Error since anchor (ms)
+bool timesync_have_drift;                   // Drift estimated at least once
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Functions
+////////////////////////////////////////////////////////////////////////////////
+
+void timesync_init(void){
+    timesync_valid = false;
+    timesync_drift = 0;
+    timesync_error = 0;
+    timesync_base = 0;
+    timesync_last = 0;
+    timesync_frac = 0;
+    timesync_have_drift = false;
+}
+
+void timesync_update(uint32_t now){
+    uint32_t elapsed = now - timesync_last;
+
+    // elapsed * drift fits in 32 bits for elapsed under 40s
+    timesync_frac += (int32_t)elapsed * timesync_drift;
+    timesync_base += elapsed + timesync_frac / 1000000;
+    timesync_frac %= 1000000;
+    timesync_last = now;
+}
+
+uint64_t timesync_time(uint32_t now){
+    uint32_t elapsed = now - timesync_last;
+    return timesync_base + elapsed +
+            ((int32_t)elapsed * timesync_drift + timesync_frac) / 1000000;
+}
+
+void timesync_set(uint64_t host, uint32_t now){
+    int64_t error;
+    int32_t ppm;
+    uint32_t interval, mag, q, r;
+
+    timesync_update(now);
+    if(!timesync_valid){
+        // First sync. Nothing to compare with.
+        timesync_error = 0;
+        timesync_acc = 0;
+        timesync_anchor = now;
+    }else{
+        error = (int64_t)(host - timesync_base);
+        if(error > INT32_MAX)
+            timesync_error = INT32_MAX;
+        else if(error < INT32_MIN)
+            timesync_error = INT32_MIN;
+        else
+            timesync_error = error;
+
+        // Saturate (a step that large is out of range below anyway)
+        if(timesync_error > 0 && timesync_acc > INT32_MAX - timesync_error)
+            timesync_acc = INT32_MAX;
+        else if(timesync_error < 0 && timesync_acc < INT32_MIN - timesync_error)
+            timesync_acc = INT32_MIN;
+        else
+            timesync_acc += timesync_error;
+
+        // Each sync removes the error so far. Sum of errors since anchor is
+        // the drift over that interval (with the current correction).
+        interval = now - timesync_anchor;
+        if(interval >= TIMESYNC_INTERVAL_MIN){
+            mag = timesync_acc < 0 ? -(uint32_t)timesync_acc : (uint32_t)timesync_acc;
+            if(mag > interval / (1000000 / TIMESYNC_DRIFT_MAX)){
+                // Out of range: host clock stepped. Only restart interval.
+            }else{
+                // ppm = acc * 1000000 / interval as two 32-bit divisions.
+                // Scale so mag * 1000 (at most interval * 50) and r * 1000
+                // fit in 32 bits.
+                while(interval >= (1UL << 22)){
+                    interval >>= 1;
+                    mag >>= 1;
+                }
+                q = mag * 1000 / interval;
+                r = mag * 1000 % interval;
+                ppm = q * 1000 + r * 1000 / interval;
+                if(timesync_acc < 0)
+                    ppm = -ppm;
+
+                // Half of later estimates (sync error is +/- a timer tick)
+                timesync_drift += timesync_have_drift ? ppm / 2 : ppm;
+                if(timesync_drift > TIMESYNC_DRIFT_MAX)
+                    timesync_drift = TIMESYNC_DRIFT_MAX;
+                else if(timesync_drift < -TIMESYNC_DRIFT_MAX)
+                    timesync_drift = -TIMESYNC_DRIFT_MAX;
+                timesync_have_drift = true;
+            }
+            timesync_acc = 0;
+            timesync_anchor = now;
+        }
+    }
+    timesync_base = host;
+    timesync_frac = 0;
+    timesync_valid = true;
+}
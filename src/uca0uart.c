@@ -30,14 +30,126 @@
 #include <uca0uart.h>
 #include <msp430.h>
 #include <msp430helper.h>
-#include <circular_buffer.h>
+#include <spsc_buffer.h>
+#include <fmt.h>
+#include <ports.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Macros
 ////////////////////////////////////////////////////////////////////////////////
 
-#define WB_SIZE             32              // Write buffer size
-#define RB_SIZE             32              // Read buffer size
+#define WB_SIZE             UCA0UART_WB_SIZE
+#define RB_SIZE             16              // Read buffer size
+#define PB_SIZE             16              // Priority write buffer size
+
+#if !SPSC_IS_POW2(WB_SIZE) || !SPSC_IS_POW2(RB_SIZE) || !SPSC_IS_POW2(PB_SIZE)
+#error "uca0uart: buffer sizes must be powers of two"
+#endif
+#if WB_SIZE > 255 || RB_SIZE > 255 || PB_SIZE > 255
+#error "uca0uart: high-water marks are 8-bit"
+#endif
+
+// Baud rate clock (SMCLK; see system.c). Can be overridden at build time.
+#ifndef UCA0UART_BRCLK
+#define UCA0UART_BRCLK      1000000UL
+#endif
+
+// Use oversampling mode (UCOS16) for rates where BRCLK / baud >= 16
+#ifndef UCA0UART_OVERSAMPLE
+#define UCA0UART_OVERSAMPLE 0
+#endif
+
+// Max allowed baud rate error (per mille) for any supported rate
+#ifndef UCA0UART_TOLERANCE
+#define UCA0UART_TOLERANCE  20
+#endif
+
+// Max allowed error (per mille of a bit) of any bit in a character
+#ifndef UCA0UART_BIT_TOLERANCE
+#define UCA0UART_BIT_TOLERANCE 100
+#endif
+
+// Rates built in (bit 1 << uca0uart_BUAD_* for each). Every one must be
+// within both tolerances at UCA0UART_BRCLK or the build fails. 9600 is always
+// built in. 115200 needs a faster clock (e.g. 8MHz with oversampling).
+#ifndef UCA0UART_RATES
+#define UCA0UART_RATES      ((1 << uca0uart_BUAD_19200) | (1 << uca0uart_BUAD_38400) | \
+                            (1 << uca0uart_BUAD_57600))
+#endif
+#define RATE_BUILT(r)       ((UCA0UART_RATES >> (r)) & 1)
+
+// Baud rate divisor calculation (see slau144j section 15.3.10)
+// Oversampling: N = BRCLK / baud, UCBRx = INT(N / 16), UCBRFx = round(N % 16)
+// Low frequency: UCBRx = INT(N), UCBRSx = round(frac(N) * 8)
+// In both cases DIV is N rounded to the modulation step (1/16 or 1/8)
+#define BAUD_OS(b)          (UCA0UART_OVERSAMPLE && UCA0UART_BRCLK / (b) >= 16)
+#define BAUD_SCALE(b)       (BAUD_OS(b) ? 1UL : 8UL)
+#define BAUD_STEP(b)        (BAUD_OS(b) ? 16UL : 8UL)
+#define BAUD_DIV(b)         ((UCA0UART_BRCLK * BAUD_SCALE(b) + (b) / 2) / (b))
+#define BAUD_BR(b)          (BAUD_DIV(b) / BAUD_STEP(b))
+#define BAUD_MOD(b)         (BAUD_DIV(b) % BAUD_STEP(b))
+#define BAUD_MCTL(b)        (BAUD_OS(b) ? ((BAUD_MOD(b) << 4) | UCOS16) : (BAUD_MOD(b) << 1))
+
+// Average baud rate error (per mille, rounded down)
+#define BAUD_ACTUAL_X1000(b) (UCA0UART_BRCLK * BAUD_SCALE(b) * 1000 / BAUD_DIV(b))
+#define BAUD_ERROR(b)       ((BAUD_ACTUAL_X1000(b) > (b) * 1000 ? \
+        BAUD_ACTUAL_X1000(b) - (b) * 1000 : (b) * 1000 - BAUD_ACTUAL_X1000(b)) / (b))
+
+// Worst error of any single bit edge or sample point in a 10 bit character
+// (per mille of a bit; slau144j section 15.3.10.3). Times are in 1/16 BRCLK.
+// Low frequency mode modulates each bit by the UCBRSx pattern (bit 0 first;
+// repeats after 8 bits). TX bit j ends after (j + 1) * UCBRx + sum of pattern
+// bits 0 to j BRCLK periods. RX bit j is sampled after 2 * INT(UCBRx / 2) +
+// j * UCBRx + the same sum, plus up to one BRCLK of start edge sync delay. In
+// oversampling mode every bit is the same length (average error accumulates).
+#define BAUD_PAT(b)         ((0xFEEEAEAA2A220200ULL >> (BAUD_MOD(b) * 8)) & 0xFF)
+#define BAUD_PAT_BIT(b, i)  ((BAUD_PAT(b) >> ((i) & 7)) & 1)
+#define BAUD_PAT_SUM(b, j)  (BAUD_PAT_BIT(b, 0) + ((j) >= 1) * BAUD_PAT_BIT(b, 1) + \
+        ((j) >= 2) * BAUD_PAT_BIT(b, 2) + ((j) >= 3) * BAUD_PAT_BIT(b, 3) + \
+        ((j) >= 4) * BAUD_PAT_BIT(b, 4) + ((j) >= 5) * BAUD_PAT_BIT(b, 5) + \
+        ((j) >= 6) * BAUD_PAT_BIT(b, 6) + ((j) >= 7) * BAUD_PAT_BIT(b, 7) + \
+        ((j) >= 8) * BAUD_PAT_BIT(b, 8) + ((j) >= 9) * BAUD_PAT_BIT(b, 9))
+#define BAUD_TX_T(b, j)     (BAUD_OS(b) ? 16 * ((j) + 1) * BAUD_DIV(b) : \
+        16 * (((j) + 1) * BAUD_BR(b) + BAUD_PAT_SUM(b, j)))
+#define BAUD_RX_T(b, j)     (BAUD_OS(b) ? 16 * ((j) + 1) * BAUD_DIV(b) : \
+        16 * (BAUD_BR(b) / 2 * 2 + (j) * BAUD_BR(b) + BAUD_PAT_SUM(b, j)))
+#define BAUD_T_ERROR(t, b, j) ((((t) * (b) > ((j) + 1) * 16 * UCA0UART_BRCLK) ? \
+        (t) * (b) - ((j) + 1) * 16 * UCA0UART_BRCLK : \
+        ((j) + 1) * 16 * UCA0UART_BRCLK - (t) * (b)) * 1000 / (16 * UCA0UART_BRCLK))
+#define BAUD_BIT_OK(b, j)   (BAUD_T_ERROR(BAUD_TX_T(b, j), b, j) <= UCA0UART_BIT_TOLERANCE && \
+        BAUD_T_ERROR(BAUD_RX_T(b, j), b, j) <= UCA0UART_BIT_TOLERANCE && \
+        BAUD_T_ERROR(BAUD_RX_T(b, j) + 16, b, j) <= UCA0UART_BIT_TOLERANCE)
+#define BAUD_BITS_OK(b)     (BAUD_BIT_OK(b, 0) && BAUD_BIT_OK(b, 1) && BAUD_BIT_OK(b, 2) && \
+        BAUD_BIT_OK(b, 3) && BAUD_BIT_OK(b, 4) && BAUD_BIT_OK(b, 5) && BAUD_BIT_OK(b, 6) && \
+        BAUD_BIT_OK(b, 7) && BAUD_BIT_OK(b, 8) && BAUD_BIT_OK(b, 9))
+
+// Rate can be used (average and per bit error within tolerance)
+#define BAUD_OK(b)          (BAUD_ERROR(b) <= UCA0UART_TOLERANCE && BAUD_BITS_OK(b))
+
+// Set all baud rate registers for a rate
+#define SET_BAUD(b)         UCA0BR1 = BAUD_BR(b) >> 8; \
+                            UCA0BR0 = BAUD_BR(b) & 0xFF; \
+                            UCA0MCTL = BAUD_MCTL(b)
+
+// 9600 is the fallback for every other rate so it must always work
+#if !BAUD_OK(9600UL)
+#error "uca0uart: 9600 baud error exceeds UCA0UART_TOLERANCE / UCA0UART_BIT_TOLERANCE"
+#endif
+#if RATE_BUILT(uca0uart_BUAD_19200) && !BAUD_OK(19200UL)
+#error "uca0uart: 19200 baud error exceeds tolerance (remove it from UCA0UART_RATES)"
+#endif
+#if RATE_BUILT(uca0uart_BUAD_38400) && !BAUD_OK(38400UL)
+#error "uca0uart: 38400 baud error exceeds tolerance (remove it from UCA0UART_RATES)"
+#endif
+#if RATE_BUILT(uca0uart_BUAD_57600) && !BAUD_OK(57600UL)
+#error "uca0uart: 57600 baud error exceeds tolerance (remove it from UCA0UART_RATES)"
+#endif
+#if RATE_BUILT(uca0uart_BUAD_115200) && !BAUD_OK(115200UL)
+#error "uca0uart: 115200 baud error exceeds tolerance (remove it from UCA0UART_RATES)"
+#endif
+#if BAUD_BR(9600UL) > 0xFFFF
+#error "uca0uart: UCA0UART_BRCLK too fast for 9600 baud"
+#endif
 
 // Note: Which IE and IFG registers change if not using UCA0
 #define ENABLE_TX_INT       IE2 |= UCA0TXIE
@@ -53,20 +165,42 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// Globals
 ////////////////////////////////////////////////////////////////////////////////
-volatile uint8_t uca0uart_rb_array[WB_SIZE]; // Backing array for read buffer
-volatile uint8_t uca0uart_wb_array[RB_SIZE]; // Backing array for write buffer
-volatile circular_buffer uca0uart_rb;        // Read circular (ring) buffer
-volatile circular_buffer uca0uart_wb;        // Write circular (write) buffer
+volatile uint8_t uca0uart_rb_array[RB_SIZE]; // Backing array for read buffer
+volatile uint8_t uca0uart_wb_array[WB_SIZE]; // Backing array for write buffer
+volatile spsc_buffer uca0uart_rb;            // Read circular (ring) buffer
+volatile spsc_buffer uca0uart_wb;            // Write circular (write) buffer
+volatile uint8_t uca0uart_pb_array[PB_SIZE]; // Backing array for priority buffer
+volatile spsc_buffer uca0uart_pb;            // Priority write buffer
+uca0uart_segment_ring uca0uart_segments;     // Caller owned data to send
+volatile unsigned int uca0uart_wait_len;     // Space uca0uart_wait_avail needs
+uint8_t uca0uart_end_byte;                   // Last byte of every message
+bool uca0uart_message_end;                   // Last byte sent ended a message
+volatile unsigned int uca0uart_end_mark;     // Write position ending a message
+volatile bool uca0uart_end_marked;           // uca0uart_end_mark not reached yet
+
+unsigned int uca0uart_tx_drop_msgs;
+unsigned int uca0uart_tx_drop_bytes;
+volatile unsigned int uca0uart_rx_drops;
+uint8_t uca0uart_wb_high;
+uint8_t uca0uart_pb_high;
+volatile uint8_t uca0uart_rb_high;
 
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Functions
 ////////////////////////////////////////////////////////////////////////////////
 
-void uca0uart_init(unsigned int baud){
+bool uca0uart_init(unsigned int baud){
+    bool ok;
+
     // Initialize circular buffers
-    cb_init(&uca0uart_rb, uca0uart_rb_array, RB_SIZE);
-    cb_init(&uca0uart_wb, uca0uart_wb_array, WB_SIZE);
+    spsc_init(&uca0uart_rb, uca0uart_rb_array, RB_SIZE);
+    spsc_init(&uca0uart_wb, uca0uart_wb_array, WB_SIZE);
+    spsc_init(&uca0uart_pb, uca0uart_pb_array, PB_SIZE);
+    uca0uart_segment_ring_init(&uca0uart_segments);
+    uca0uart_wait_len = 0;
+    uca0uart_end_byte = '\n';
+    uca0uart_message_end = true;
 
     // Configure UCA0 for UART
     UCA0CTL1 = UCSWRST;                 // Put USCI module in reset state
@@ -80,7 +214,7 @@ void uca0uart_init(unsigned int baud){
     UCA0CTL0 &= ~UCSYNC;                // Asynchronous mode
     UCA0CTL1 |= UCSSEL_2;               // SMCLK as BRCLK src (1MHz)
 
-    uca0uart_set_buad(baud);             // Baud rate configuration
+    ok = uca0uart_set_buad(baud);       // Baud rate configuration
 
     DISABLE_TX_INT;                     // Disable TX interrupt
     DISABLE_RX_INT;                     // Disable RX interrupt
@@ -92,82 +226,274 @@ void uca0uart_init(unsigned int baud){
 
     SET_TX_IFG;                         // Set TX interrupt flag
     // Leave TX interrupt disabled
+    return ok;
 }
 
-void uca0uart_set_buad(unsigned int baud){
+bool uca0uart_set_buad(unsigned int baud){
     // For details on where the baud rate settings come from see
     // https://www.ti.com/lit/ug/slau144j/slau144j.pdf
-    // Calculations described on page 421
-    // Page 424 has a helpful table
+    // Calculations described on page 421 (done by BAUD_* macros at compile
+    // time). Page 424 has a helpful table to compare against. Rates not in
+    // UCA0UART_RATES are left out and fall back to 9600.
     switch(baud){
-    default:
     case uca0uart_BUAD_9600:
-        UCA0BR1 = 0x00;                 // UCBRx = 104 (upper byte)
-        UCA0BR0 = 0x68;                 // UCBRx = 104 (lower byte)
-        UCA0MCTL = 0x02;                // UCBRFx = 0, UCBRSx = 1, UCOS16 = 0
-        break;
+        SET_BAUD(9600UL);               // 1MHz: UCBRx = 104, UCBRSx = 1
+        return true;
+#if RATE_BUILT(uca0uart_BUAD_19200)
+    case uca0uart_BUAD_19200:
+        SET_BAUD(19200UL);              // 1MHz: UCBRx = 52, UCBRSx = 1
+        return true;
+#endif
+#if RATE_BUILT(uca0uart_BUAD_38400)
+    case uca0uart_BUAD_38400:
+        SET_BAUD(38400UL);              // 1MHz: UCBRx = 26, UCBRSx = 0
+        return true;
+#endif
+#if RATE_BUILT(uca0uart_BUAD_57600)
+    case uca0uart_BUAD_57600:
+        SET_BAUD(57600UL);              // 1MHz: UCBRx = 17, UCBRSx = 3
+        return true;
+#endif
+#if RATE_BUILT(uca0uart_BUAD_115200)
+    case uca0uart_BUAD_115200:
+        SET_BAUD(115200UL);             // 8MHz (oversampling): UCBRx = 4, UCBRFx = 5
+        return true;
+#endif
+    default:
+        SET_BAUD(9600UL);
+        return false;
     }
 }
 
+/**
+ * Track most bytes ever queued in the write buffer (call after writing)
+ */
+void uca0uart_wrote(void){
+    unsigned int used = SPSC_AVAIL_READ(&uca0uart_wb);
+    if(used > uca0uart_wb_high)
+        uca0uart_wb_high = used;
+    ENABLE_TX_INT;
+}
+
 unsigned int uca0uart_write_str(char *str){
-    unsigned int pos = 0;
-    while(true){
-        if(str[pos] == '\0')
-            break;
-        if(!cb_write(&uca0uart_wb, (uint8_t)str[pos]))
-            break;
-        ++pos;
+    spsc_span spans[2];
+    unsigned int i, j, pos = 0;
+
+    // Copy directly into free space (no need to find length first)
+    spsc_peek_write(&uca0uart_wb, spans);
+    for(i = 0; i < 2; ++i){
+        for(j = 0; j < spans[i].len && str[pos] != '\0'; ++j)
+            spans[i].data[j] = str[pos++];
     }
-    ENABLE_TX_INT;
+    spsc_commit_write(&uca0uart_wb, pos);
+    uca0uart_wrote();
+    for(j = pos; str[j] != '\0'; ++j)
+        uca0uart_tx_drop_bytes++;       // Did not fit
     return pos;
 }
 
 bool uca0uart_write_byte(uint8_t b){
-    bool res = cb_write(&uca0uart_wb, b);
-    ENABLE_TX_INT;
+    bool res = spsc_write(&uca0uart_wb, b);
+    uca0uart_wrote();
+    if(!res)
+        uca0uart_tx_drop_bytes++;
     return res;
 }
 
 unsigned int uca0uart_write_bytes(uint8_t *data, unsigned int len){
-    unsigned int pos = 0;
-    while(true){
-        if(pos == len)
-            break;
-        if(!cb_write(&uca0uart_wb, data[pos]))
-            break;
-        ++pos;
+    unsigned int n = spsc_write_block(&uca0uart_wb, data, len);
+    uca0uart_wrote();
+    uca0uart_tx_drop_bytes += len - n;
+    return n;
+}
+
+unsigned int uca0uart_write_fixed(int32_t value, unsigned int decimals, unsigned int width){
+    spsc_span spans[2];
+    unsigned int len;
+
+    // Digits go straight into free space (no intermediate string)
+    spsc_peek_write(&uca0uart_wb, spans);
+    len = fmt_fixed(value, decimals, width, spans);
+    if(len == 0)
+        uca0uart_tx_drop_bytes += fmt_fixed_len(value, decimals, width);
+    spsc_commit_write(&uca0uart_wb, len);
+    uca0uart_wrote();
+    return len;
+}
+
+unsigned int uca0uart_write_uint64(uint64_t value){
+    spsc_span spans[2];
+    unsigned int len;
+
+    spsc_peek_write(&uca0uart_wb, spans);
+    len = fmt_uint64(value, spans);
+    if(len == 0)
+        uca0uart_tx_drop_bytes += fmt_uint64_len(value);
+    spsc_commit_write(&uca0uart_wb, len);
+    uca0uart_wrote();
+    return len;
+}
+
+void uca0uart_peek_write(spsc_span spans[2]){
+    spsc_peek_write(&uca0uart_wb, spans);
+}
+
+void uca0uart_commit_write(unsigned int len){
+    spsc_commit_write(&uca0uart_wb, len);
+    uca0uart_wrote();
+}
+
+bool uca0uart_reserve(unsigned int len){
+    if(SPSC_AVAIL_WRITE(&uca0uart_wb) < len){
+        uca0uart_tx_drop_msgs++;
+        return false;
     }
+    return true;
+}
+
+void uca0uart_commit(void){
+    uca0uart_wrote();
+}
+
+bool uca0uart_wait_avail(unsigned int len){
+    if(len > WB_SIZE)
+        return false;
+    uca0uart_wait_len = len;
+    while(SPSC_AVAIL_WRITE(&uca0uart_wb) < len){
+        ENABLE_TX_INT;
+        // TX ISR exits LPM0 once enough space. If the buffer empties before
+        // LPM0 is entered the next timer interrupt (at most 10ms) does.
+        LPM0;
+    }
+    uca0uart_wait_len = 0;
+    return true;
+}
+
+bool uca0uart_write_priority(uint8_t *data, unsigned int len){
+    unsigned int used;
+    if(SPSC_AVAIL_WRITE(&uca0uart_pb) < len)
+        return false;                   // All or nothing
+    spsc_write_block(&uca0uart_pb, data, len);
+    used = SPSC_AVAIL_READ(&uca0uart_pb);
+    if(used > uca0uart_pb_high)
+        uca0uart_pb_high = used;
     ENABLE_TX_INT;
-    return pos;
+    return true;
+}
+
+void uca0uart_set_message_end(uint8_t b){
+    uca0uart_end_byte = b;
+}
+
+void uca0uart_end_message(void){
+    DISABLE_TX_INT;                     // ISR must not see a partial update
+    if(SPSC_EMPTY(&uca0uart_wb) && RING_EMPTY(&uca0uart_segments)){
+        uca0uart_end_marked = false;
+        uca0uart_message_end = true;    // Already sent
+    }else{
+        uca0uart_end_mark = uca0uart_wb.head;
+        uca0uart_end_marked = true;
+    }
+    uca0uart_wrote();                   // Also sends waiting priority bytes
+}
+
+bool uca0uart_write_segment(const uint8_t *data, unsigned int len, volatile bool *done){
+    uca0uart_segment *seg;
+
+    if(len == 0){
+        if(done != NULL)
+            *done = true;
+        return true;
+    }
+    seg = uca0uart_segment_ring_reserve(&uca0uart_segments);
+    if(seg == NULL)
+        return false;
+    seg->data = data;
+    seg->len = len;
+    seg->mark = uca0uart_wb.head;       // Send after bytes written so far
+    seg->done = done;
+    uca0uart_segment_ring_commit(&uca0uart_segments);
+    ENABLE_TX_INT;
+    return true;
+}
+
+unsigned int uca0uart_segment_avail(void){
+    return UCA0UART_SEGMENTS - RING_COUNT(&uca0uart_segments);
+}
+
+unsigned int uca0uart_write_avail(void){
+    return SPSC_AVAIL_WRITE(&uca0uart_wb);
 }
 
 bool uca0uart_read_byte(uint8_t *dest){
-    return cb_read(&uca0uart_rb, dest);
+    return spsc_read(&uca0uart_rb, dest);
 }
 
 unsigned int uca0uart_read_bytes(uint8_t *dest, unsigned int count){
-    unsigned int pos = 0;
-    while(true){
-        if(pos == count)
-            break;
-        if(!cb_read(&uca0uart_rb, &dest[pos]))
-            break;
-        ++pos;
-    }
-    return pos;
+    return spsc_read_block(&uca0uart_rb, dest, count);
 }
 
-void uca0uart_handle_write(void){
+bool uca0uart_handle_write(void){
     uint8_t b;
-    cb_read(&uca0uart_wb, &b);          // Read next byte
-    if(CB_EMPTY(&uca0uart_wb))
+    uca0uart_segment *seg;
+
+    // Priority bytes first, but only between messages (never inside a line
+    // or frame, or while a segment, e.g. a history dump, is queued)
+    if(!uca0uart_message_end || !RING_EMPTY(&uca0uart_segments) ||
+            !spsc_read(&uca0uart_pb, &b)){
+        // Segment is sent once write buffer bytes queued before it are sent
+        seg = uca0uart_segment_ring_peek(&uca0uart_segments);
+        if(seg != NULL && uca0uart_wb.tail == seg->mark){
+            // Sent bytes are removed from the front of the segment
+            b = *seg->data++;
+            if(--seg->len == 0){
+                if(seg->done != NULL)
+                    *seg->done = true;  // Caller's buffer no longer used
+                uca0uart_segment_ring_release(&uca0uart_segments);
+            }
+        }else if(!spsc_read(&uca0uart_wb, &b)){
+            // Only priority bytes left. They wait for the rest of the message
+            // (TX interrupt is enabled again when it is written).
+            DISABLE_TX_INT;
+            return uca0uart_wait_len != 0;
+        }
+        if(uca0uart_end_marked && uca0uart_wb.tail == uca0uart_end_mark &&
+                RING_EMPTY(&uca0uart_segments)){
+            uca0uart_end_marked = false;
+            uca0uart_message_end = true;    // End of uca0uart_end_message
+        }else{
+            uca0uart_message_end = b == uca0uart_end_byte;
+        }
+    }
+    if(SPSC_EMPTY(&uca0uart_wb) && SPSC_EMPTY(&uca0uart_pb) &&
+            RING_EMPTY(&uca0uart_segments))
         DISABLE_TX_INT;                 // Nothing left. Don't run ISR next time
                                         // IFG gets set when this byte done
                                         // So next time write is called and ISR
                                         // enabled, IFG will be set to start tx
+    RS485_TXEN_ON;                      // Drive RS-485 line (if used)
     UCA0TXBUF = b;                      // Put next byte in TXBUF
+
+    // Wake uca0uart_wait_avail once enough space
+    return uca0uart_wait_len != 0 && SPSC_AVAIL_WRITE(&uca0uart_wb) >= uca0uart_wait_len;
+}
+
+bool uca0uart_handle_txen(void){
+    if(IE2 & UCA0TXIE)
+        return true;                    // Sending again. Checked once done.
+    if(UCA0STAT & UCBUSY)
+        return false;                   // Last byte still shifting out
+    RS485_TXEN_OFF;                     // Release line for other nodes
+    return true;
 }
 
 void uca0uart_handle_read(void){
-    cb_write(&uca0uart_rb, UCA0RXBUF);
+    unsigned int used;
+    if(!spsc_write(&uca0uart_rb, UCA0RXBUF)){
+        uca0uart_rx_drops++;
+        return;
+    }
+    used = SPSC_AVAIL_READ(&uca0uart_rb);
+    if(used > uca0uart_rb_high)
+        uca0uart_rb_high = used;
 }